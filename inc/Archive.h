@@ -0,0 +1,85 @@
+#ifndef MYCCLINKER_ARCHIVE_H
+#define MYCCLINKER_ARCHIVE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "Linker.h"
+
+// Library archive (`.lib`): object files stored back to back behind an index
+// of the names they define. A link reads only the index up front; a member is
+// parsed when a reference reaches one of its symbols (see SymbolResolver.h).
+//
+// Layout (little-endian):
+//   ArchiveHeader
+//   ArchiveMember[member_count]
+//   ArchiveSymbol[symbol_count]   DEFINED and WEAK names of every member
+//   string table                  NUL-terminated names, string_table_size bytes
+//   member data                   unmodified .obj files (LNK1/LNK2, any flags)
+// tools/lib_gen.py builds archives from .obj files.
+const uint32_t ARCHIVE_MAGIC = 0x4C4E4B41;  // "LNKA"
+const uint32_t ARCHIVE_VERSION = 1;
+
+#pragma pack(push, 1)
+
+struct ArchiveHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t member_count;
+    uint32_t symbol_count;
+    uint32_t string_table_size;
+};
+
+struct ArchiveMember {
+    uint32_t name_offset;  // Into the string table
+    uint32_t data_offset;  // From the start of the file
+    uint32_t data_size;
+};
+
+struct ArchiveSymbol {
+    uint32_t name_offset;
+    uint32_t member;       // Index into the member table
+};
+
+#pragma pack(pop)
+
+// Inputs named *.lib are archives; everything else is an object file.
+bool is_archive_path(const std::string& path);
+
+// An archive mapped for the duration of a link. Opening it validates the
+// index only; members are parsed on demand by load_member().
+class Archive {
+public:
+    struct Symbol {
+        const char* name;  // Points into the mapping
+        uint32_t member;
+    };
+
+    Archive() = default;
+    Archive(const Archive&) = delete;
+    Archive& operator=(const Archive&) = delete;
+    ~Archive();
+
+    bool open(const std::string& path, std::ostream& err = std::cerr);
+
+    const std::string& path() const { return path_; }
+    size_t member_count() const { return members_.size(); }
+    // In index order; a name may appear once per member that defines it
+    const std::vector<Symbol>& symbols() const { return symbols_; }
+
+    // Parses member `index`; obj.filename becomes "<archive>(<member>)"
+    bool load_member(uint32_t index, LoadedObject& obj, std::ostream& err = std::cerr) const;
+
+private:
+    std::string path_;
+    const uint8_t* data_ = nullptr;
+    size_t size_ = 0;
+    std::vector<ArchiveMember> members_;
+    std::vector<std::string> member_names_;
+    std::vector<Symbol> symbols_;
+};
+
+#endif  // MYCCLINKER_ARCHIVE_H
@@ -0,0 +1,34 @@
+#ifndef MYCCLINKER_BUILD_ID_H
+#define MYCCLINKER_BUILD_ID_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "TaskScheduler.h"
+
+// Content-derived image identifier (`--build-id`).
+//
+// Two-level SHA-256 tree over the image file as written without --compress
+// (including a segmented image's header), so that it can be hashed by
+// several threads at once:
+//   leaf[i] = SHA-256(0x00 || image[i * LEAF_SIZE .. (i + 1) * LEAF_SIZE))
+//   id      = SHA-256(0x01 || le64(image_size) || leaf[0] || leaf[1] || ...)
+// The digest is stored at __build_id (BUILD_ID_SIZE bytes in data). Those
+// bytes are zero while hashing, so to check an image, zero them again and
+// recompute.
+const size_t BUILD_ID_SIZE = 32;
+const size_t BUILD_ID_LEAF_SIZE = 64 * 1024;
+#define BUILD_ID_SYMBOL "__build_id"
+
+void sha256(const uint8_t* data, size_t size, uint8_t digest[32]);
+
+// Tree hash of `image`; leaves are hashed in parallel on `scheduler`. The
+// result does not depend on the thread count.
+void compute_build_id(const std::vector<uint8_t>& image, TaskScheduler& scheduler,
+                      uint8_t digest[BUILD_ID_SIZE]);
+
+std::string build_id_hex(const uint8_t digest[BUILD_ID_SIZE]);
+
+#endif  // MYCCLINKER_BUILD_ID_H
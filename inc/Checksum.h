@@ -0,0 +1,16 @@
+#ifndef MYCCLINKER_CHECKSUM_H
+#define MYCCLINKER_CHECKSUM_H
+
+#include <cstddef>
+#include <cstdint>
+
+// CRC32C (Castagnoli, reflected polynomial 0x82F63B78), initial value and
+// final XOR 0xFFFFFFFF: crc32c("123456789") == 0xE3069283. Uses the SSE4.2
+// crc32 instruction when the CPU has it, otherwise a lookup table.
+uint32_t crc32c(const uint8_t* data, size_t size);
+
+// Copies `size` bytes from `src` to `dst` and returns the CRC32C of them,
+// touching each byte once.
+uint32_t crc32c_copy(uint8_t* dst, const uint8_t* src, size_t size);
+
+#endif  // MYCCLINKER_CHECKSUM_H
@@ -0,0 +1,33 @@
+#ifndef MYCCLINKER_COMPRESSION_H
+#define MYCCLINKER_COMPRESSION_H
+
+#include <cstddef>
+#include <cstdint>
+// In-tree codec for the LZ4 block format (no frame, no checksum):
+//   token       high nibble = literal length, low nibble = match length - 4
+//               (15 means "more length bytes follow", each adding up to 255)
+//   literals
+//   offset      16-bit little-endian distance back into the output (1..65535)
+//   [match length bytes]
+// The last sequence carries literals only.
+
+#include <vector>
+
+// Worst-case compressed size of `src_size` input bytes.
+size_t lz4_compress_bound(size_t src_size);
+
+// Most output one byte of a block can produce: a length byte adds at most
+// 255, and a token with its literals or minimum match never more. Lets a
+// reader reject a claimed decoded size before allocating for it.
+const uint64_t LZ4_MAX_RATIO = 255;
+
+// Encodes `src` as one self-contained block, appending it to `out`.
+// Returns the number of bytes appended.
+size_t lz4_compress_block(const uint8_t* src, size_t src_size, std::vector<uint8_t>& out);
+
+// Decodes one block into exactly `dst_size` bytes at `dst`.
+// Returns false on malformed input, out-of-range offsets, or a size mismatch;
+// never reads or writes outside the given buffers.
+bool lz4_decompress_block(const uint8_t* src, size_t src_size, uint8_t* dst, size_t dst_size);
+
+#endif  // MYCCLINKER_COMPRESSION_H
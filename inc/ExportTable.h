@@ -0,0 +1,56 @@
+#ifndef MYCCLINKER_EXPORT_TABLE_H
+#define MYCCLINKER_EXPORT_TABLE_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "SymbolTable.h"
+
+// Name -> address lookup table emitted into the image (`--export-table`).
+//
+// Minimal perfect hash in the hash-and-displace (CHD) style: keys are split
+// into buckets by export_hash(name, 0) % bucket_count, and each bucket gets a
+// seed that sends all of its keys to distinct slots via
+// export_hash(name, seed) % entry_count. A lookup is two hashes and a single
+// probe, followed by one string compare to reject unknown names.
+//
+// Encoded layout (32-bit big-endian words, at symbol __export_table):
+//   [0] EXPORT_TABLE_MAGIC
+//   [1] entry_count (n)
+//   [2] bucket_count (r)
+//   [3] reserved (0)
+//   [4 .. 4+r)            per-bucket seeds
+//   [4+r .. 4+r+2n)       entries: { name address, symbol address }
+//   then the NUL-terminated names, padded to 4 bytes
+struct ExportTable {
+    std::vector<std::string> slots;     // Names in slot order
+    std::vector<uint32_t> seeds;        // One per bucket
+    std::vector<uint32_t> name_offsets; // Offset of each slot's name within the table
+    uint32_t encoded_size = 0;
+};
+
+const uint32_t EXPORT_TABLE_MAGIC = 0x45585054;  // "EXPT"
+#define EXPORT_TABLE_SYMBOL "__export_table"
+
+// 32-bit FNV-1a over the name bytes, starting from
+// 0x811C9DC5 ^ (seed * 0x9E3779B9), followed by a short avalanche
+// (h ^= h >> 16; h *= 0x85EBCA6B; h ^= h >> 13). Target code must use the
+// exact same function.
+uint32_t export_hash(const char* name, uint32_t seed);
+
+// Reads symbol names from `path`, one per line; '#' starts a comment.
+bool read_export_list(const std::string& path, std::vector<std::string>& names);
+
+// Builds the hash layout. Addresses are not needed yet, so this can run
+// before layout; the encoded size is final once this returns.
+bool build_export_table(const std::vector<std::string>& names, ExportTable& table);
+
+// Serializes `table` for placement at `table_addr`, taking symbol addresses
+// from `symbols`. `out` is resized to table.encoded_size bytes.
+bool encode_export_table(const ExportTable& table,
+                         uint32_t table_addr,
+                         const SymbolTable& symbols,
+                         std::vector<uint8_t>& out);
+
+#endif  // MYCCLINKER_EXPORT_TABLE_H
@@ -0,0 +1,105 @@
+#ifndef MYCCLINKER_IMAGE_FORMAT_H
+#define MYCCLINKER_IMAGE_FORMAT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "TaskScheduler.h"
+
+// Block-compressed output image (`--compress`).
+//
+// The flat image is cut into fixed-size blocks that are compressed
+// independently, so a loader can decode them in parallel or only when a block
+// is first touched. Layout (little-endian, like the object format):
+//   CompressedImageHeader
+//   CompressedBlockEntry[block_count]
+//   block payloads, each at its entry's `offset`
+const uint32_t COMPRESSED_IMAGE_MAGIC = 0x495A4C4D;  // "MLZI"
+const uint32_t COMPRESSED_IMAGE_VERSION = 1;
+const uint32_t DEFAULT_IMAGE_BLOCK_SIZE = 64 * 1024;
+
+// Block stored uncompressed because LZ4 did not make it smaller
+const uint32_t IMAGE_BLOCK_STORED = 0x1;
+
+// Segmented image, written instead of the flat dump when the regions in use
+// lie so far apart that more than MAX_IMAGE_GAP zero bytes would have to be
+// stored between them (a scratchpad at 0x40000000 next to RAM at 0).
+// Layout (little-endian):
+//   SegmentedImageHeader
+//   ImageSegmentEntry[segment_count], in address order
+//   segment contents, each at its entry's `offset`
+// `--compress` wraps this file like it wraps a flat image.
+const uint32_t SEGMENTED_IMAGE_MAGIC = 0x47534C4D;  // "MLSG"
+const uint32_t SEGMENTED_IMAGE_VERSION = 1;
+const uint32_t MAX_IMAGE_GAP = 64 * 1024;
+
+#pragma pack(push, 1)
+
+struct CompressedImageHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t header_size;   // sizeof(CompressedImageHeader)
+    uint32_t block_size;    // Uncompressed bytes per block; the last may be shorter
+    uint32_t block_count;
+    uint32_t image_size;    // Total uncompressed bytes
+    uint32_t image_base;    // Load address of the first image byte
+    uint32_t reserved;
+};
+
+struct CompressedBlockEntry {
+    uint32_t offset;           // From the start of the file
+    uint32_t compressed_size;  // Bytes stored for this block
+    uint32_t flags;            // IMAGE_BLOCK_*
+};
+
+struct SegmentedImageHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t header_size;    // sizeof(SegmentedImageHeader)
+    uint32_t segment_count;
+};
+
+struct ImageSegmentEntry {
+    uint32_t address;  // Load address of the first byte
+    uint32_t size;
+    uint32_t offset;   // From the start of the file
+};
+
+#pragma pack(pop)
+
+// The address ranges an output file stores and where each one sits in it.
+// A single segment starting at the image base is the flat dump.
+struct ImageSegments {
+    std::vector<ImageSegmentEntry> entries;
+    uint32_t base = 0;        // Load address of the lowest stored byte
+    size_t file_size = 0;
+    bool segmented = false;   // Write the SegmentedImageHeader and table
+
+    // Offset in the file of a stored address
+    size_t file_offset(uint32_t address) const;
+};
+
+// Merges the stored [start, end) extents of the regions in use into
+// segments. Extents less than MAX_IMAGE_GAP apart share a segment, zero
+// filled between them. `image_base` anchors the first segment so that a
+// layout without large gaps gives exactly the flat dump from `image_base`.
+ImageSegments plan_image_segments(uint32_t image_base,
+                                  std::vector<std::pair<uint64_t, uint64_t>> extents);
+
+// Writes the segmented header and segment table at the front of `file`,
+// which must already be `segments.file_size` bytes. Does nothing for a flat
+// image.
+void write_segment_table(const ImageSegments& segments, std::vector<uint8_t>& file);
+
+// Encodes an image file (flat or segmented) into the block-compressed
+// container. Blocks are compressed in parallel on `scheduler`; the output
+// does not depend on it.
+void encode_compressed_image(const std::vector<uint8_t>& image,
+                             uint32_t image_base,
+                             uint32_t block_size,
+                             TaskScheduler& scheduler,
+                             std::vector<uint8_t>& out);
+
+#endif  // MYCCLINKER_IMAGE_FORMAT_H
@@ -0,0 +1,23 @@
+#ifndef MYCCLINKER_IMAGE_HANDOFF_H
+#define MYCCLINKER_IMAGE_HANDOFF_H
+
+#include <string>
+#include <vector>
+
+// Output that never touches the filesystem (`--output-memfd`): the image is
+// linked into an anonymous memfd, sealed against further changes, and the
+// linker then replaces itself with the consumer (e.g. MyEmulator), which
+// inherits the descriptor.
+//
+// The consumer finds the descriptor number in the MLLINKER_IMAGE_FD
+// environment variable and in place of every "{fd}" in its arguments. The
+// file offset is 0 and the contents are exactly the output file bytes
+// (flat or --compress).
+
+// Creates the memfd the link writes into, named after `name`.
+bool create_image_memfd(const std::string& name, int& fd);
+
+// Seals `fd` and execs `command`. Returns only on failure.
+bool exec_with_image(int fd, const std::vector<std::string>& command);
+
+#endif  // MYCCLINKER_IMAGE_HANDOFF_H
@@ -0,0 +1,11 @@
+#ifndef MYCCLINKER_JSON_OUTPUT_H
+#define MYCCLINKER_JSON_OUTPUT_H
+
+#include <ostream>
+#include <string>
+
+// Writes `text` as a quoted JSON string, escaping quotes, backslashes and
+// control characters. Shared by the --stats, --dump and --size-report writers.
+void write_json_string(std::ostream& out, const std::string& text);
+
+#endif  // MYCCLINKER_JSON_OUTPUT_H
@@ -0,0 +1,33 @@
+#ifndef MYCCLINKER_LIBRARY_SEARCH_H
+#define MYCCLINKER_LIBRARY_SEARCH_H
+
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+// In-memory listing of one library search directory.
+// Built by a single directory scan and then shared by every lookup (and every
+// link) in the process, so probing N candidate names across M directories
+// costs M scans instead of N*M stat calls.
+struct DirectoryIndex {
+    std::string path;
+    bool exists = false;
+    std::unordered_set<std::string> entries;  // Names of regular files only
+};
+
+// Returns the cached index for `dir`, scanning it on first use.
+// Safe to call from multiple threads.
+const DirectoryIndex& get_directory_index(const std::string& dir);
+
+// Drops every cached index (e.g. when a long-running process knows the
+// library directories changed on disk).
+void clear_directory_index_cache();
+
+// Resolves `-l name` against `search_dirs` in order.
+// Candidates per directory: lib<name>.obj, <name>.obj, lib<name>.lib.
+// `-l :file` looks for exactly `file`.
+bool find_library(const std::vector<std::string>& search_dirs,
+                  const std::string& name,
+                  std::string& resolved_path);
+
+#endif  // MYCCLINKER_LIBRARY_SEARCH_H
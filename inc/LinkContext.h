@@ -0,0 +1,63 @@
+#ifndef MYCCLINKER_LINK_CONTEXT_H
+#define MYCCLINKER_LINK_CONTEXT_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Linker.h"
+#include "SymbolResolver.h"
+#include "SymbolTable.h"
+#include "TaskScheduler.h"
+#include "UringReader.h"
+
+// What a link allocates that is worth keeping for the next one: the worker
+// threads, the io_uring ring with its read arena, the resolver's interned
+// names, the global symbol table's buckets, the image buffers and every
+// object's section and table buffers. A process that links many times (an
+// in-process test runner) passes one context to every link_objects() call.
+// Each link starts with reset(), which empties the containers but keeps
+// their capacity. Objects are parked with their buffers rather than
+// destroyed, and the next link loads into them.
+//
+// A context serves one link at a time. Contexts share no mutable state (the
+// library directory cache is internally locked), so links on different
+// threads are safe as long as each thread has its own context.
+class LinkContext {
+public:
+    LinkContext() = default;
+    LinkContext(const LinkContext&) = delete;
+    LinkContext& operator=(const LinkContext&) = delete;
+
+    // Clears per-link state, keeping allocated memory, threads and the ring
+    void reset(bool record_activations);
+
+    // Created on first use and kept until a link asks for another count
+    // (`--threads`, 0 = one per CPU)
+    TaskScheduler& scheduler(unsigned threads);
+
+    // The ring, set up on first use; nullptr if io_uring is not available
+    UringReader* uring_reader();
+
+    // An empty object, reusing the buffers of a parked one if there is one
+    LoadedObject recycled_object();
+    // Empties `obj` and parks its buffers for recycled_object()
+    void recycle(LoadedObject& obj);
+
+    SymbolResolver resolver;
+    SymbolTable symbol_table;
+    std::vector<LoadedObject> objects;
+    std::vector<std::string> load_errors;
+    std::vector<uint8_t> image;
+    std::vector<uint8_t> compressed_image;
+
+private:
+    std::vector<LoadedObject> spare_objects_;
+    std::unique_ptr<TaskScheduler> scheduler_;
+    unsigned scheduler_request_ = 0;
+    std::unique_ptr<UringReader> reader_;
+    bool reader_tried_ = false;
+};
+
+#endif  // MYCCLINKER_LINK_CONTEXT_H
@@ -0,0 +1,55 @@
+#ifndef MYCCLINKER_LINK_STATS_H
+#define MYCCLINKER_LINK_STATS_H
+
+#include <sys/types.h>
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "PerfCounters.h"
+
+// Per-phase timing of one link, written as JSON by `--stats=FILE`. With
+// `--perf-counters` each phase also gets event counts for every scheduler
+// thread, so one can tell whether e.g. relocation is memory- or
+// compute-bound. If the kernel refuses the counters, the phases are still
+// timed and the "perf_counters" key says why.
+class LinkStats {
+public:
+    // Row 0 counts the thread constructing the stats (the one running the
+    // link, which need not be the one that created a reused scheduler);
+    // the other rows count thread_ids[1..], the scheduler's workers.
+    LinkStats(bool perf_counters, const std::vector<pid_t>& thread_ids);
+
+    // Ends the running phase, if any, and starts timing `name`
+    void begin_phase(const char* name);
+    void end_phase();
+
+    // Adds a top-level "key": value entry, kept in insertion order
+    void set(const std::string& key, uint64_t value);
+
+    bool write_json(const std::string& path) const;
+
+private:
+    struct PhaseRecord {
+        std::string name;
+        double wall_ms = 0;
+        std::vector<PerfSample> per_thread;  // Deltas, one per thread
+    };
+
+    std::vector<PerfSample> sample_all() const;
+
+    std::vector<std::unique_ptr<ThreadCounters>> counters_;
+    std::string perf_status_;
+    std::vector<std::pair<std::string, uint64_t>> values_;
+    std::vector<PhaseRecord> phases_;
+    bool in_phase_ = false;
+
+    std::chrono::steady_clock::time_point phase_start_;
+    std::vector<PerfSample> phase_start_samples_;
+};
+
+#endif  // MYCCLINKER_LINK_STATS_H
@@ -13,14 +13,63 @@ struct LoadedObject {
     FileHeader header;
     std::vector<uint8_t> text_section;
     std::vector<uint8_t> data_section;
+    std::vector<uint8_t> sdata_section;
     std::vector<SymbolEntry> symbols;
     std::vector<RelocEntry> relocs;
+    // Set by the loader from the file size and the CRC32C of the header and
+    // of each stored part. Byte-identical files always get the same value.
+    uint64_t content_hash = 0;
 
     // Calculated during Pass 1
     uint32_t text_base_addr;
     uint32_t data_base_addr;
+    uint32_t sdata_base_addr = 0;
+    uint32_t bss_base_addr = 0;
+    uint32_t text_padding = 0;  // Alignment gap placed right before text_base_addr
+
+    // Back to an empty object, keeping the buffers' capacity (LinkContext)
+    void clear();
+};
+
+// Size of one of an object's sections (SECTION_*), and its address once
+// layout has run. Everything that reports on the layout goes through these.
+uint32_t section_size(const LoadedObject& obj, uint32_t section);
+uint32_t section_base(const LoadedObject& obj, uint32_t section);
+
+// One input on the link line, in command-line order.
+struct LinkInput {
+    std::string name;
+    bool is_library = false;  // true for `-l name`, resolved against library_paths
 };
 
+struct LinkOptions {
+    std::string output_path;
+    std::vector<LinkInput> inputs;
+    std::vector<std::string> library_paths;  // `-L dir`, searched in order
+    std::string memory_layout_path;          // `-T file`: region definitions (empty = default)
+    uint32_t align_functions = 0;            // `--align-functions=N`: minimum text alignment
+    uint32_t text_fill = NOP_INSTRUCTION;    // `--text-fill=W`: word written into text alignment gaps
+    bool relax = false;                      // `--relax`: delete branches to the next instruction
+    std::vector<std::string> wrap_symbols;   // `--wrap=sym`: redirect sym -> __wrap_sym
+    std::string export_table_path;           // `--export-table=file`: names to hash into the image
+    bool compress = false;                   // `--compress`: write the block-compressed image container
+    bool build_id = false;                   // `--build-id`: embed a tree hash of the image at __build_id
+    unsigned threads = 0;                    // `--threads=N`: worker threads incl. the caller (0 = all cores)
+    bool io_uring = true;                    // `--no-io-uring` clears: batch input reads through io_uring
+    std::string stats_path;                  // `--stats=file`: per-phase timings as JSON
+    bool perf_counters = false;              // `--perf-counters`: add per-thread PMU counts to the stats
+    std::string size_report_path;            // `--size-report=file`: per-object/symbol sizes as JSON
+    std::string shared_symbols_path;         // `--shared=file`: link a shared image, export its symbols
+    std::vector<std::string> link_shared;    // `--link-shared=file`: resolve against prelinked images
+    int output_fd = -1;                      // `--output-fd=N`: write the image here, not to output_path
+};
+
+class LinkContext;
+
+bool link_objects(const LinkOptions& options);
+// Same, but threads, the io_uring ring and buffers come from `context` and
+// stay allocated for its next link (see LinkContext.h)
+bool link_objects(const LinkOptions& options, LinkContext& context);
 bool link_objects(const std::vector<std::string>& input_files, const std::string& output_path);
 
 #endif  // MYCCLINKER_LINKER_H
@@ -0,0 +1,66 @@
+#ifndef MYCCLINKER_MEMORY_REGIONS_H
+#define MYCCLINKER_MEMORY_REGIONS_H
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+// What a region's memory allows, from an attribute made of r, w and x
+enum RegionAccess : uint32_t {
+    REGION_READ = 1,
+    REGION_WRITE = 2,
+    REGION_EXEC = 4,
+};
+
+// A named range of target memory that sections can be placed into.
+struct MemoryRegion {
+    std::string name;
+    uint32_t origin = 0;
+    uint64_t length = 0;   // 64-bit so a region may span all of 4 GiB
+    uint32_t access = 0;   // REGION_* bits; 0 when no access attribute was given
+    bool fast = false;     // `fast` attribute: where `place` without a region goes
+
+    // Filled in during layout
+    uint64_t used = 0;
+
+    // Text needs an executable region, every other section a writable one.
+    // A region without an access attribute takes anything.
+    bool allows_section(uint32_t section) const;
+};
+
+// Region definitions plus placement rules, read from a `-T` file.
+//
+//   # name   origin      length      attributes
+//   region   rom   0x00000000  0x00001000  rx
+//   region   ram   0x00001000  0x000FF000  rw
+//   region   spm   0x40000000  0x00001000  rwx fast scratchpad
+//   place    .text rom          # whole output section
+//   place    .data ram
+//   place    hot_loop rom       # object section that defines hot_loop
+//   place    hot_table          # no region: the first region marked fast
+//
+// An attribute of only r/w/x letters sets the region's access, which every
+// section placed there is checked against. `fast` marks the region that
+// `place` rules without a region go to. Other attributes are labels for the
+// reader and are ignored.
+//
+// Sections without a rule go to the first region. Placing a symbol moves the
+// defining object's section (text or data) as a unit, since symbols have no
+// extent of their own. Small data (.sdata) and .bss can only be placed as a whole.
+struct MemoryLayout {
+    std::vector<MemoryRegion> regions;
+    std::map<uint32_t, size_t> section_region;     // SECTION_* -> region index
+    std::map<std::string, size_t> symbol_region;   // symbol name -> region index
+
+    // Lowest origin of any declared region; the output image starts here.
+    uint32_t image_base() const;
+};
+
+// Single region starting at 0 covering the whole address space, which
+// reproduces the classic "text at 0, data right after" layout.
+MemoryLayout default_memory_layout();
+
+bool parse_memory_layout_file(const std::string& path, MemoryLayout& layout);
+
+#endif  // MYCCLINKER_MEMORY_REGIONS_H
@@ -0,0 +1,24 @@
+#ifndef MYCCLINKER_OBJECT_DUMP_H
+#define MYCCLINKER_OBJECT_DUMP_H
+
+#include <string>
+#include <vector>
+
+// `mllinker --dump`: inspects objects with the linker's own loader instead of
+// tools/obj_dump.py. Files are loaded and formatted in parallel on the task
+// scheduler, then printed in the order given (directories in sorted order).
+struct DumpOptions {
+    std::vector<std::string> paths;  // Object files, or directories searched recursively for *.obj
+    bool json = false;               // `--json`: one JSON document instead of text
+    bool summary = false;            // `--summary`: sizes and counts only, one line per object
+    bool duplicates = false;         // `--duplicates`: report symbols defined in more than one object
+    unsigned width = 16;             // `--width=N`: bytes per hexdump line
+    unsigned threads = 0;            // `--threads=N`, as for linking
+    bool io_uring = true;            // `--no-io-uring`, as for linking
+};
+
+// Returns false if an input could not be found or loaded (every other input
+// is still dumped) or if --duplicates found any.
+bool dump_objects(const DumpOptions& options);
+
+#endif  // MYCCLINKER_OBJECT_DUMP_H
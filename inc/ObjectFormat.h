@@ -7,17 +7,78 @@
 // However, checking endianness might be important. Let's assume Little Endian for now as is common.
 const uint32_t LINKER_MAGIC = 0x4C4E4B31;
 
+// "LNK2" -> 0x4C4E4B32
+// Same layout as LNK1, but the header records its own size and the size of
+// each symbol/relocation entry. Readers zero-fill fields they do not find and
+// skip fields they do not know, so fields can be appended without a new magic.
+const uint32_t LINKER_MAGIC_V2 = 0x4C4E4B32;
+
+// Sizes of the fixed LNK1 structures
+const uint32_t FILE_HEADER_V1_SIZE = 20;
+const uint32_t SYMBOL_ENTRY_V1_SIZE = 76;
+const uint32_t RELOC_ENTRY_V1_SIZE = 72;
+
 // Section Types
 const uint32_t SECTION_TEXT = 0;
 const uint32_t SECTION_DATA = 1;
+const uint32_t SECTION_SDATA = 2; // Small data, addressed relative to __sdata_base (LNK2)
+const uint32_t SECTION_BSS = 3;   // Zero-initialized, occupies no file bytes (LNK2)
+
+// Linker-defined bounds of BSS, for startup code to clear
+#define BSS_START_SYMBOL "__bss_start"
+#define BSS_END_SYMBOL "__bss_end"
+
+// Small-data addressing: the linker defines SDATA_BASE_SYMBOL at
+// start-of-.sdata + SDATA_BASE_BIAS, so a signed 16-bit displacement from the
+// base register covers the whole (at most SDATA_MAX_SIZE byte) section.
+#define SDATA_BASE_SYMBOL "__sdata_base"
+const uint32_t SDATA_BASE_BIAS = 0x8000;
+const uint32_t SDATA_MAX_SIZE = 0x10000;
 
 // Symbol Types
 const uint32_t SYMBOL_UNDEFINED = 0; // Import
 const uint32_t SYMBOL_DEFINED = 1;   // Export
+const uint32_t SYMBOL_WEAK = 2;      // Export, overridden by any DEFINED or COMMON symbol
+const uint32_t SYMBOL_COMMON = 3;    // Tentative: `size` bytes in BSS, merged by name (largest wins)
 
 // Relocation Types
 const uint32_t RELOC_ABSOLUTE = 0; // 32-bit absolute address
 const uint32_t RELOC_RELATIVE = 1; // 26-bit relative jump (for CALL/B)
+// Split 32-bit address materialization across two consecutive instructions,
+// patching the low 16-bit immediate field of each:
+//     hi-instr  rD, %hi(sym)     ; offset
+//     lo-instr  rD, rD, %lo(sym) ; offset + 4
+// The LO16 immediate is sign-extended by the CPU, so HI16 carries
+// (sym + 0x8000) >> 16. Every HI16 must be followed by a LO16 for the same
+// symbol at offset + 4.
+const uint32_t RELOC_HI16 = 2;
+const uint32_t RELOC_LO16 = 3;
+// Signed 16-bit (sym - __sdata_base) into the low immediate field, range-checked
+const uint32_t RELOC_SDA16 = 4;
+// Same encoding as RELATIVE, but marks a plain (possibly conditional) branch
+// with no side effects. Under --relax a BRANCH26 that lands on the next
+// instruction is deleted; CALLs must keep using RELATIVE.
+const uint32_t RELOC_BRANCH26 = 5;
+
+// Header flags (LNK2)
+// Every PC-relative reference and code address in the text section is
+// expressed through a relocation, so the linker may delete instructions.
+const uint32_t OBJ_FLAG_RELAXABLE = 0x1;
+// Each stored part (text, data, sdata, symbol table, relocation table) is a
+// uint32_t compressed length followed by an LZ4 block (see Compression.h).
+// Uncompressed sizes come from the header as usual.
+const uint32_t OBJ_FLAG_COMPRESSED = 0x2;
+// The header carries a CRC32C (see Checksum.h) of each stored part, taken over
+// the bytes as they appear in the file (the LZ4 block for compressed parts,
+// without its length word).
+const uint32_t OBJ_FLAG_CHECKSUMS = 0x4;
+
+// Default fill word for alignment gaps in text, written big-endian like every
+// instruction word the linker patches. The instruction encoding belongs to
+// MyAssembler and is not recorded in this tree, so nothing here proves 0 is a
+// no-op: it is only what the gaps between sections have always held. Targets
+// whose nop is another word pass it with `--text-fill`.
+const uint32_t NOP_INSTRUCTION = 0x00000000;
 
 #pragma pack(push, 1)
 
@@ -27,19 +88,40 @@ struct FileHeader {
     uint32_t data_size;
     uint32_t symtable_count;
     uint32_t reloc_count;
+
+    // LNK2 only
+    uint32_t header_size;       // Bytes of header actually present in the file
+    uint32_t symbol_entry_size; // Stride of the symbol table
+    uint32_t reloc_entry_size;  // Stride of the relocation table
+    uint32_t flags;             // OBJ_FLAG_*
+    uint32_t text_align;        // Required start alignment (power of two, 0/1 = none)
+    uint32_t data_align;
+    uint32_t sdata_size;        // Small data follows the data section in the file
+    uint32_t sdata_align;
+    uint32_t bss_size;          // Not stored in the file
+    uint32_t bss_align;
+    uint32_t text_crc;          // OBJ_FLAG_CHECKSUMS only
+    uint32_t data_crc;
+    uint32_t sdata_crc;
+    uint32_t symtable_crc;
+    uint32_t reloc_crc;
 };
 
 struct SymbolEntry {
     char name[64];
-    uint32_t type;    // 0=UNDEFINED, 1=DEFINED
-    uint32_t section; // 0=TEXT, 1=DATA
+    uint32_t type;    // 0=UNDEFINED, 1=DEFINED, 2=WEAK, 3=COMMON
+    uint32_t section; // 0=TEXT, 1=DATA, 2=SDATA, 3=BSS (ignored for COMMON)
     uint32_t offset;  // Offset relative to section start
+
+    // LNK2 only
+    uint32_t align;   // Required alignment of the symbol's address (0/1 = none)
+    uint32_t size;    // Extent in bytes (0 = unknown); required for COMMON
 };
 
 struct RelocEntry {
     uint32_t offset;      // Offset in the TEXT section to patch
     char symbol_name[64]; // Name of the symbol to resolve
-    uint32_t type;        // 0=ABSOLUTE, 1=RELATIVE
+    uint32_t type;        // 0=ABSOLUTE, 1=RELATIVE, 2=HI16, 3=LO16, 4=SDA16, 5=BRANCH26
 };
 
 #pragma pack(pop)
@@ -0,0 +1,43 @@
+#ifndef MYCCLINKER_OBJECT_LOADER_H
+#define MYCCLINKER_OBJECT_LOADER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "Linker.h"
+#include "TaskScheduler.h"
+#include "UringReader.h"
+
+// Maps and parses one .obj file (LNK1 or LNK2, plain or compressed,
+// optionally checksummed). Falls back to reading it if it cannot be mapped.
+// Errors go to `err`, so parallel loads can report in link order.
+bool load_object_file(const std::string& path, LoadedObject& obj, std::ostream& err = std::cerr);
+
+// The same for a descriptor that is already open on `path`; closes `fd`.
+bool load_object_fd(int fd, const std::string& path, LoadedObject& obj, std::ostream& err = std::cerr);
+
+// Parses an object image already in memory. `name` is used for messages and
+// becomes obj.filename.
+bool parse_object_buffer(const uint8_t* data, size_t size, const std::string& name,
+                         LoadedObject& obj, std::ostream& err = std::cerr);
+
+// Loads objects[i] from paths[i] for every i on `scheduler`. With
+// `use_io_uring` the files are read in io_uring batches (see UringReader.h)
+// and parsed in parallel; if the kernel does not offer io_uring, every file
+// goes through load_object_file() instead. `on_done(i, ok)` runs exactly
+// once per file, on whichever thread finished it; on failure errors[i]
+// holds the message. A `reader` that is already initialized is used instead
+// of setting up a ring for this call.
+void load_object_files(const std::vector<std::string>& paths,
+                       std::vector<LoadedObject>& objects,
+                       std::vector<std::string>& errors,
+                       TaskScheduler& scheduler,
+                       bool use_io_uring,
+                       const std::function<void(size_t, bool)>& on_done,
+                       UringReader* reader = nullptr);
+
+#endif  // MYCCLINKER_OBJECT_LOADER_H
@@ -0,0 +1,51 @@
+#ifndef MYCCLINKER_PERF_COUNTERS_H
+#define MYCCLINKER_PERF_COUNTERS_H
+
+#include <sys/types.h>
+
+#include <cstdint>
+
+// Per-thread event counters read through perf_event_open(2) (`--perf-counters`).
+enum PerfEvent {
+    PERF_CYCLES,
+    PERF_INSTRUCTIONS,
+    PERF_CACHE_MISSES,
+    PERF_BRANCH_MISSES,
+    PERF_TASK_CLOCK,  // Software event: CPU time in ns, available even in most VMs
+    PERF_EVENT_COUNT
+};
+
+// Key used for each event in the stats JSON
+extern const char* const PERF_EVENT_NAMES[PERF_EVENT_COUNT];
+
+struct PerfSample {
+    uint64_t values[PERF_EVENT_COUNT] = {};
+    bool valid[PERF_EVENT_COUNT] = {};
+};
+
+// Counters for a single thread, user space only. Each event has its own fd;
+// if the kernel multiplexes them, reads are scaled by enabled/running time.
+class ThreadCounters {
+public:
+    ThreadCounters() = default;
+    ~ThreadCounters();
+
+    ThreadCounters(const ThreadCounters&) = delete;
+    ThreadCounters& operator=(const ThreadCounters&) = delete;
+
+    // Opens every event for thread `tid`. Events the kernel rejects (e.g.
+    // no PMU in a VM) stay closed. Returns false if none could be opened,
+    // with `error` set to the errno of the first failure.
+    bool open(pid_t tid, int& error);
+
+    // Reads the current totals; may be called from any thread.
+    PerfSample read() const;
+
+private:
+    int fds_[PERF_EVENT_COUNT] = {-1, -1, -1, -1, -1};
+};
+
+// Kernel thread id of the calling thread.
+pid_t current_thread_id();
+
+#endif  // MYCCLINKER_PERF_COUNTERS_H
@@ -0,0 +1,40 @@
+#ifndef MYCCLINKER_SHARED_IMAGE_H
+#define MYCCLINKER_SHARED_IMAGE_H
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+// A prelinked shared image: a library linked once at a fixed address
+// (`--shared=<file>`), which programs then link against by symbol table only
+// (`--link-shared=<file>`). The loader maps the library image next to the
+// program image; no library bytes are copied into the program.
+//
+// The symbol file is text, one record per line ('#' starts a comment):
+//   image  <base> <size> <path>   lowest stored address, file size before
+//                                 --compress, and where the file was written
+//   range  <start> <end>          address range [start, end) the library occupies
+//   bss    <start> <end>          part of the ranges the loader must zero
+//   symbol <name> <address>
+// Numbers are hex with a 0x prefix. There is one range per memory region the
+// library used.
+struct SharedImage {
+    std::string symbols_path;  // File this was read from
+    std::string image_path;
+    uint32_t image_base = 0;
+    uint32_t image_size = 0;
+    uint32_t bss_start = 0;
+    uint32_t bss_end = 0;
+    std::vector<std::pair<uint64_t, uint64_t>> ranges;
+    std::map<std::string, uint32_t> symbols;
+};
+
+bool read_shared_image(const std::string& path, SharedImage& image);
+bool write_shared_image(const std::string& path, const SharedImage& image);
+
+// True if [start, end) intersects one of the image's ranges
+bool shared_image_overlaps(const SharedImage& image, uint64_t start, uint64_t end);
+
+#endif  // MYCCLINKER_SHARED_IMAGE_H
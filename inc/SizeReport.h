@@ -0,0 +1,29 @@
+#ifndef MYCCLINKER_SIZE_REPORT_H
+#define MYCCLINKER_SIZE_REPORT_H
+
+#include <string>
+#include <vector>
+
+#include "Linker.h"
+#include "SymbolTable.h"
+
+// Why one linked object is in the image (`--size-report`)
+struct ObjectReason {
+    std::string symbol;     // Needed symbol it was the provider for
+    std::string needed_by;  // Object whose relocation needed it; empty for a root
+    bool generated = false; // Linker-owned object (e.g. <common>); no reason applies
+};
+
+// Writes a JSON breakdown of the image: for each linked object, in link
+// order, the bytes it adds to every section (plus text alignment padding)
+// and why it was activated; for each symbol it defines, its section, final
+// address, extent and whether it won resolution. `reasons[i]` describes
+// `objects[i]`. Extents come from the symbol's `size` field when set;
+// otherwise they run to the next symbol in the same section (or its end)
+// and are marked "inferred".
+bool write_size_report(const std::string& path,
+                       const std::vector<LoadedObject>& objects,
+                       const std::vector<ObjectReason>& reasons,
+                       const SymbolTable& global_symbol_table);
+
+#endif  // MYCCLINKER_SIZE_REPORT_H
@@ -0,0 +1,164 @@
+#ifndef MYCCLINKER_SYMBOL_RESOLVER_H
+#define MYCCLINKER_SYMBOL_RESOLVER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Linker.h"
+
+// Merged tentative definition: the largest size and strictest alignment seen
+struct CommonSymbol {
+    uint32_t size = 0;
+    uint32_t align = 0;
+};
+
+const size_t NO_OBJECT = SIZE_MAX;
+const uint32_t NO_MEMBER = UINT32_MAX;
+
+// Why an object was linked in: the first of its symbols found to be needed,
+// and the object whose relocation first needed it (NO_OBJECT for roots).
+struct Activation {
+    std::string symbol;
+    size_t needed_by = NO_OBJECT;
+};
+
+// Where a symbol stands while the link line is being read
+enum class SymbolState : uint8_t {
+    UNDEFINED,  // Nothing added so far defines it
+    LAZY,       // Only an archive member that has not been loaded defines it
+    DEFINED,    // An added object defines it (strong, COMMON or weak)
+};
+
+// Loads archive member `member` (numbered as in add_lazy_symbol) and returns
+// the object and the index it takes. The object must stay at that address
+// until finish() returns.
+using MemberFetcher = std::function<bool(uint32_t member, const LoadedObject*& obj, size_t& index)>;
+
+// Decides which objects are linked in, one object at a time, so resolution
+// can run while later objects are still loading.
+//
+// Precedence: strong definition > COMMON > weak. Strong providers of a needed
+// symbol are activated as soon as both the need and the provider are known.
+// A weak provider only counts when nothing stronger exists anywhere on the
+// link line, which is only known after the last object, so weak activation
+// waits for finish().
+//
+// Archive members are lazy: only their index names are known until a need
+// reaches a LAZY symbol, and then that member is fetched and activated on the
+// spot. A name defined by an added object (even weakly) or by an earlier
+// archive never fetches a member, so the work done is proportional to the
+// members used, not to the size of the libraries.
+//
+// Names are interned once; all per-symbol state is kept by symbol ID.
+// Interned names outlive a link: reset() only starts a new link number, and a
+// symbol's state is cleared the first time the new link looks it up.
+class SymbolResolver {
+public:
+    // With `record_activations`, activations() explains every active object
+    // (for --size-report). Off by default to keep the hot path lean.
+    explicit SymbolResolver(bool record_activations = false)
+        : record_activations_(record_activations) {}
+
+    // Forgets the previous link but keeps the interned names and the tables'
+    // memory (LinkContext)
+    void reset(bool record_activations);
+
+    void add_root(const std::string& name);
+
+    // Defines `name` outside the link (a --link-shared image). The import
+    // counts as a strong definition: no archive member or weak provider is
+    // linked in for it, and it is left out of needed(). An object that
+    // defines it strongly is still activated when it is referenced, like any
+    // strong provider, so the clash can be reported.
+    void add_import(const std::string& name, uint32_t address);
+
+    // Treats every definition in every added object as a root, so all inputs
+    // are linked (--shared).
+    void link_every_object() { link_every_object_ = true; }
+
+    void set_member_fetcher(MemberFetcher fetcher) { fetcher_ = std::move(fetcher); }
+
+    // Objects must be added in link-line order: index 0, 1, 2, ... `obj`
+    // must stay at the same address until finish() returns.
+    void add_object(const LoadedObject& obj, size_t index);
+
+    // Records that archive member `member` defines `name`, at the archive's
+    // place on the link line. The member is fetched now if `name` is already
+    // needed and undefined.
+    void add_lazy_symbol(const char* name, uint32_t member);
+
+    // Applies the weak rules once every object has been added.
+    void finish();
+
+    // True once a member fetch has failed (the fetcher reported why)
+    bool failed() const { return failed_; }
+
+    const std::vector<bool>& active() const { return active_; }
+    // The three sets below are filled in by finish()
+    const std::set<std::string>& needed() const { return needed_; }
+    const std::set<std::string>& strong_names() const { return strong_names_; }
+    const std::map<std::string, CommonSymbol>& commons() const { return commons_; }
+    // Indexed like active(); empty unless recording was requested
+    const std::vector<Activation>& activations() const { return activations_; }
+    const std::map<std::string, uint32_t>& imports() const { return imports_; }
+
+private:
+    using SymbolId = uint32_t;
+
+    struct Symbol {
+        std::string name;
+        SymbolState state = SymbolState::UNDEFINED;
+        bool needed = false;
+        bool strong = false;
+        bool common = false;
+        bool imported = false;
+        size_t needed_by = NO_OBJECT;
+        size_t weak_provider = NO_OBJECT;    // First weak definition
+        uint32_t lazy_member = NO_MEMBER;    // Only while LAZY
+        CommonSymbol common_size;
+        std::vector<size_t> waiting;         // Strong providers not yet activated
+        uint32_t link = 0;                   // Link whose state this is
+
+        // Per-link state back to UNDEFINED; the name and buffers stay
+        void reset(uint32_t current_link);
+    };
+
+    SymbolId intern(const char* name);
+    void register_object(const LoadedObject& obj, size_t index);
+    void need(SymbolId id, size_t needed_by);
+    void fetch(uint32_t member, SymbolId id);
+    void activate(size_t index, SymbolId id);
+    void drain();
+
+    std::unordered_map<std::string, SymbolId> ids_;
+    std::vector<Symbol> symbols_;
+    std::string lookup_;              // Key buffer for intern(), reused
+    uint32_t link_ = 1;               // Bumped by reset()
+    std::vector<SymbolId> live_;      // Symbols this link has looked up
+    std::vector<SymbolId> weak_names_;  // Symbols with a weak provider
+
+    std::vector<const LoadedObject*> objects_;
+    std::vector<bool> active_;
+    std::vector<bool> fetched_;  // Per archive member
+    // Objects activated but whose references are not yet scanned
+    std::vector<size_t> worklist_;
+    MemberFetcher fetcher_;
+    bool failed_ = false;
+
+    std::set<std::string> needed_;
+    std::set<std::string> strong_names_;
+    std::map<std::string, CommonSymbol> commons_;
+
+    std::map<std::string, uint32_t> imports_;
+    bool link_every_object_ = false;
+    bool record_activations_;
+    std::vector<Activation> activations_;
+};
+
+#endif  // MYCCLINKER_SYMBOL_RESOLVER_H
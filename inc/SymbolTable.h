@@ -0,0 +1,50 @@
+#ifndef MYCCLINKER_SYMBOL_TABLE_H
+#define MYCCLINKER_SYMBOL_TABLE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// The global name -> address table, split into shards by name hash so that
+// define_symbols can fill every shard on its own thread. A name always lives
+// in shard_of(name); lookups go straight to that shard. Iteration order is
+// unspecified, so anything that prints the table sorts it first.
+class SymbolTable {
+public:
+    static const size_t SHARD_COUNT = 64;
+    using Shard = std::unordered_map<std::string, uint32_t>;
+
+    SymbolTable() : shards_(SHARD_COUNT) {}
+
+    static size_t shard_of(const std::string& name) {
+        return std::hash<std::string>()(name) % SHARD_COUNT;
+    }
+
+    // Empties every shard but keeps its buckets (LinkContext)
+    void clear();
+
+    // nullptr if `name` is not defined
+    const uint32_t* find(const std::string& name) const;
+    bool contains(const std::string& name) const { return find(name) != nullptr; }
+
+    // Adds `name` unless it is already defined; returns whether it was added
+    bool insert(const std::string& name, uint32_t address) {
+        return shards_[shard_of(name)].emplace(name, address).second;
+    }
+    // Adds or overwrites
+    void set(const std::string& name, uint32_t address) { shards_[shard_of(name)][name] = address; }
+
+    // Direct access for filling shards in parallel: shard `s` may only be
+    // given names with shard_of(name) == s
+    Shard& shard(size_t s) { return shards_[s]; }
+    const std::vector<Shard>& shards() const { return shards_; }
+
+    size_t size() const;
+
+private:
+    std::vector<Shard> shards_;
+};
+
+#endif  // MYCCLINKER_SYMBOL_TABLE_H
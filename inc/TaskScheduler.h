@@ -0,0 +1,106 @@
+#ifndef MYCCLINKER_TASK_SCHEDULER_H
+#define MYCCLINKER_TASK_SCHEDULER_H
+
+#include <sys/types.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class TaskGroup;
+
+// Work-stealing thread pool shared by every parallel link phase (`--threads`).
+//
+// Each worker owns a deque: it pushes and pops its own tasks at the back
+// (LIFO, cache-warm) while idle workers steal from the front of other deques
+// (FIFO, which for recursively split ranges means the biggest pieces). The
+// thread that calls into the scheduler counts as one of the threads and helps
+// run tasks while it waits, so `threads == 1` runs everything inline.
+//
+// Scheduling never decides output: parallel phases write into per-index
+// slots and anything order-sensitive is merged in index order afterwards.
+class TaskScheduler {
+public:
+    // `threads` includes the calling thread; 0 = hardware concurrency.
+    // Counts above max_threads() are clamped to it.
+    explicit TaskScheduler(unsigned threads = 0);
+    ~TaskScheduler();
+
+    TaskScheduler(const TaskScheduler&) = delete;
+    TaskScheduler& operator=(const TaskScheduler&) = delete;
+
+    // Most threads worth running: 8 per CPU, and at least 64. Far past any
+    // useful oversubscription, and well short of where thread creation fails.
+    static unsigned max_threads();
+
+    unsigned thread_count() const { return static_cast<unsigned>(workers_.size()) + 1; }
+
+    // Kernel thread ids: [0] is the thread that created the scheduler, then
+    // one per worker. Used to attach per-thread profiling counters.
+    const std::vector<pid_t>& thread_ids() const { return thread_ids_; }
+
+    // Calls body(begin, end) over [0, count) in chunks of at most `grain`
+    // indices and returns when all are done. Ranges are split in halves, so
+    // a thief takes half of what is left rather than one chunk.
+    void parallel_for(size_t count, size_t grain, const std::function<void(size_t, size_t)>& body);
+
+    // Runs one queued task on the calling thread if any is available.
+    // Lets a thread that is waiting for something help instead of spinning.
+    bool run_one();
+
+private:
+    friend class TaskGroup;
+
+    struct Task {
+        std::function<void()> fn;
+        TaskGroup* group = nullptr;
+    };
+
+    struct WorkQueue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    void push(Task task);
+    bool take(unsigned self, Task& task);
+    void worker_loop(unsigned index);
+
+    // queues_[0] belongs to threads outside the pool, queues_[i] to worker i
+    std::vector<std::unique_ptr<WorkQueue>> queues_;
+    std::vector<std::thread> workers_;
+    std::vector<pid_t> thread_ids_;
+    std::atomic<unsigned> started_{0};
+    std::atomic<size_t> queued_{0};
+    std::atomic<bool> stopping_{false};
+    std::mutex sleep_mutex_;
+    std::condition_variable wake_;
+};
+
+// Set of tasks that can be waited for together. wait() helps run queued
+// tasks, so waiting inside a task does not tie up a worker.
+class TaskGroup {
+public:
+    explicit TaskGroup(TaskScheduler& scheduler) : scheduler_(scheduler) {}
+    ~TaskGroup() { wait(); }
+
+    TaskGroup(const TaskGroup&) = delete;
+    TaskGroup& operator=(const TaskGroup&) = delete;
+
+    // Queues `fn`, or runs it right away when the scheduler has no workers
+    void run(std::function<void()> fn);
+    void wait();
+
+private:
+    friend class TaskScheduler;
+
+    TaskScheduler& scheduler_;
+    std::atomic<size_t> pending_{0};
+};
+
+#endif  // MYCCLINKER_TASK_SCHEDULER_H
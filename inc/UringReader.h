@@ -0,0 +1,97 @@
+#ifndef MYCCLINKER_URING_READER_H
+#define MYCCLINKER_URING_READER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Batched whole-file reader on Linux io_uring, driven through the raw system
+// calls (no liburing). One batch costs a handful of io_uring_enter calls
+// instead of open/fstat/read/close per file:
+//   1. OPENAT for every file in the batch
+//   2. STATX of every opened descriptor (AT_EMPTY_PATH), so the size read
+//      is that of the file actually opened
+//   3. READ_FIXED of every file into one registered arena (plain READ if the
+//      arena could not be registered, e.g. under a low RLIMIT_MEMLOCK). The
+//      arena never grows past MAX_ARENA_SIZE: files that do not fit in what
+//      is left of it, and any file larger than that, are not read here.
+//   4. CLOSE for every file read into the arena. Anything else (a pipe, a
+//      file that did not fit) is handed back open: reopening a FIFO would
+//      wait for a second writer.
+// If the ring fails partway, every descriptor the batch still owns is closed.
+class UringReader {
+public:
+    struct FileData {
+        const uint8_t* data = nullptr;  // Into the reader's arena
+        size_t size = 0;
+        int error = 0;                  // errno of the failing step, 0 on success
+        bool open_failed = false;       // error came from opening the file
+        bool in_arena = true;           // false: not read, caller should use another path
+        int fd = -1;                    // !in_arena: the open descriptor, now the caller's
+    };
+
+    // Upper bound on the read arena, which stays allocated (and pinned when
+    // registered) between batches
+    static constexpr size_t MAX_ARENA_SIZE = 64 << 20;
+
+    UringReader() = default;
+    ~UringReader();
+
+    UringReader(const UringReader&) = delete;
+    UringReader& operator=(const UringReader&) = delete;
+
+    // Sets up the ring and checks that the kernel supports every opcode used.
+    // Returns false (with nothing to clean up) if io_uring cannot be used.
+    bool init();
+
+    // Maximum number of paths per read_batch() call
+    size_t batch_capacity() const { return batch_capacity_; }
+
+    // Reads each path completely. Results point into memory owned by the
+    // reader and stay valid until the next call. Returns false only if the
+    // ring itself failed; per-file problems are reported in `results`.
+    bool read_batch(const std::vector<const std::string*>& paths, std::vector<FileData>& results);
+
+private:
+    struct Completion {
+        uint64_t user_data;
+        int32_t res;
+    };
+
+    struct io_uring_sqe* next_sqe();
+    bool submit_and_wait(unsigned count, std::vector<Completion>& completions);
+    unsigned withdraw_unsubmitted();
+    bool ensure_arena(size_t size);
+
+    int ring_fd_ = -1;
+    size_t batch_capacity_ = 0;
+
+    // Mapped rings
+    void* sq_map_ = nullptr;
+    size_t sq_map_size_ = 0;
+    void* cq_map_ = nullptr;
+    size_t cq_map_size_ = 0;
+    struct io_uring_sqe* sqes_ = nullptr;
+    size_t sqes_size_ = 0;
+
+    unsigned* sq_head_ = nullptr;
+    unsigned* sq_tail_ = nullptr;
+    unsigned sq_mask_ = 0;
+    unsigned* sq_array_ = nullptr;
+    unsigned* cq_head_ = nullptr;
+    unsigned* cq_tail_ = nullptr;
+    unsigned cq_mask_ = 0;
+    struct io_uring_cqe* cqes_ = nullptr;
+    unsigned pending_submit_ = 0;
+
+    // File contents for the current batch; registered when possible. Left
+    // uninitialized, since the reads overwrite it anyway.
+    std::unique_ptr<uint8_t[]> arena_;
+    size_t arena_size_ = 0;
+    bool arena_registered_ = false;
+    bool can_register_ = true;
+};
+
+#endif  // MYCCLINKER_URING_READER_H
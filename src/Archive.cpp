@@ -0,0 +1,106 @@
+#include "Archive.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstring>
+
+#include "ObjectLoader.h"
+
+namespace {
+
+// Reads the NUL-terminated name at `offset` in the string table
+const char* table_string(const char* table, uint32_t table_size, uint32_t offset) {
+    if (offset >= table_size) return nullptr;
+    if (!memchr(table + offset, '\0', table_size - offset)) return nullptr;
+    return table + offset;
+}
+
+}  // namespace
+
+bool is_archive_path(const std::string& path) {
+    return path.size() > 4 && path.compare(path.size() - 4, 4, ".lib") == 0;
+}
+
+Archive::~Archive() {
+    if (data_) munmap(const_cast<uint8_t*>(data_), size_);
+}
+
+bool Archive::open(const std::string& path, std::ostream& err) {
+    path_ = path;
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        err << "Error: Could not open file " << path << std::endl;
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) ||
+        static_cast<size_t>(st.st_size) < sizeof(ArchiveHeader)) {
+        close(fd);
+        err << "Error: " << path << " is not an archive" << std::endl;
+        return false;
+    }
+    void* addr = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (addr == MAP_FAILED) {
+        err << "Error: Could not read file " << path << std::endl;
+        return false;
+    }
+    // Only the index and the members that get fetched are touched
+    madvise(addr, static_cast<size_t>(st.st_size), MADV_RANDOM);
+    data_ = static_cast<const uint8_t*>(addr);
+    size_ = static_cast<size_t>(st.st_size);
+
+    ArchiveHeader header;
+    memcpy(&header, data_, sizeof(header));
+    if (header.magic != ARCHIVE_MAGIC || header.version != ARCHIVE_VERSION) {
+        err << "Error: " << path << " is not an archive (bad magic or version)" << std::endl;
+        return false;
+    }
+
+    uint64_t members_at = sizeof(ArchiveHeader);
+    uint64_t symbols_at = members_at + uint64_t(header.member_count) * sizeof(ArchiveMember);
+    uint64_t strings_at = symbols_at + uint64_t(header.symbol_count) * sizeof(ArchiveSymbol);
+    if (strings_at + header.string_table_size > size_) {
+        err << "Error: Truncated archive index in " << path << std::endl;
+        return false;
+    }
+    const char* strings = reinterpret_cast<const char*>(data_ + strings_at);
+
+    members_.resize(header.member_count);
+    member_names_.resize(header.member_count);
+    if (header.member_count > 0) {
+        memcpy(members_.data(), data_ + members_at, members_.size() * sizeof(ArchiveMember));
+    }
+    for (size_t i = 0; i < members_.size(); ++i) {
+        const ArchiveMember& member = members_[i];
+        const char* name = table_string(strings, header.string_table_size, member.name_offset);
+        if (!name || uint64_t(member.data_offset) + member.data_size > size_) {
+            err << "Error: Corrupt member " << i << " in archive " << path << std::endl;
+            return false;
+        }
+        member_names_[i] = name;
+    }
+
+    symbols_.reserve(header.symbol_count);
+    for (uint32_t i = 0; i < header.symbol_count; ++i) {
+        ArchiveSymbol entry;
+        memcpy(&entry, data_ + symbols_at + uint64_t(i) * sizeof(ArchiveSymbol), sizeof(entry));
+        const char* name = table_string(strings, header.string_table_size, entry.name_offset);
+        if (!name || entry.member >= header.member_count) {
+            err << "Error: Corrupt symbol index entry " << i << " in archive " << path
+                << std::endl;
+            return false;
+        }
+        symbols_.push_back({name, entry.member});
+    }
+    return true;
+}
+
+bool Archive::load_member(uint32_t index, LoadedObject& obj, std::ostream& err) const {
+    const ArchiveMember& member = members_[index];
+    return parse_object_buffer(data_ + member.data_offset, member.data_size,
+                               path_ + "(" + member_names_[index] + ")", obj, err);
+}
@@ -0,0 +1,147 @@
+#include "BuildId.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+const uint32_t K[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+};
+
+inline uint32_t rotr(uint32_t x, int n) {
+    return (x >> n) | (x << (32 - n));
+}
+
+// Incremental SHA-256 (FIPS 180-4)
+class Sha256 {
+public:
+    void update(const uint8_t* data, size_t size) {
+        total_ += size;
+        if (buffered_ > 0) {
+            size_t take = std::min(size, sizeof(buffer_) - buffered_);
+            memcpy(buffer_ + buffered_, data, take);
+            buffered_ += take;
+            data += take;
+            size -= take;
+            if (buffered_ < sizeof(buffer_)) return;
+            compress(buffer_);
+            buffered_ = 0;
+        }
+        for (; size >= 64; data += 64, size -= 64) {
+            compress(data);
+        }
+        memcpy(buffer_, data, size);
+        buffered_ = size;
+    }
+
+    void finish(uint8_t digest[32]) {
+        uint64_t bits = total_ * 8;
+        uint8_t pad[72] = {0x80};
+        size_t pad_len = (buffered_ < 56 ? 56 : 120) - buffered_;
+        for (int i = 0; i < 8; ++i) {
+            pad[pad_len + i] = static_cast<uint8_t>(bits >> (56 - 8 * i));
+        }
+        update(pad, pad_len + 8);
+        for (int i = 0; i < 8; ++i) {
+            digest[4 * i + 0] = static_cast<uint8_t>(state_[i] >> 24);
+            digest[4 * i + 1] = static_cast<uint8_t>(state_[i] >> 16);
+            digest[4 * i + 2] = static_cast<uint8_t>(state_[i] >> 8);
+            digest[4 * i + 3] = static_cast<uint8_t>(state_[i]);
+        }
+    }
+
+private:
+    void compress(const uint8_t* block) {
+        uint32_t w[64];
+        for (int i = 0; i < 16; ++i) {
+            w[i] = (uint32_t{block[4 * i]} << 24) | (uint32_t{block[4 * i + 1]} << 16) |
+                   (uint32_t{block[4 * i + 2]} << 8) | uint32_t{block[4 * i + 3]};
+        }
+        for (int i = 16; i < 64; ++i) {
+            uint32_t s0 = rotr(w[i - 15], 7) ^ rotr(w[i - 15], 18) ^ (w[i - 15] >> 3);
+            uint32_t s1 = rotr(w[i - 2], 17) ^ rotr(w[i - 2], 19) ^ (w[i - 2] >> 10);
+            w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+        }
+
+        uint32_t a = state_[0], b = state_[1], c = state_[2], d = state_[3];
+        uint32_t e = state_[4], f = state_[5], g = state_[6], h = state_[7];
+        for (int i = 0; i < 64; ++i) {
+            uint32_t t1 = h + (rotr(e, 6) ^ rotr(e, 11) ^ rotr(e, 25)) + ((e & f) ^ (~e & g)) + K[i] + w[i];
+            uint32_t t2 = (rotr(a, 2) ^ rotr(a, 13) ^ rotr(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+            h = g;
+            g = f;
+            f = e;
+            e = d + t1;
+            d = c;
+            c = b;
+            b = a;
+            a = t1 + t2;
+        }
+        state_[0] += a; state_[1] += b; state_[2] += c; state_[3] += d;
+        state_[4] += e; state_[5] += f; state_[6] += g; state_[7] += h;
+    }
+
+    uint32_t state_[8] = {0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+                          0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19};
+    uint8_t buffer_[64];
+    size_t buffered_ = 0;
+    uint64_t total_ = 0;
+};
+
+void hash_leaf(const uint8_t* data, size_t size, uint8_t digest[32]) {
+    const uint8_t prefix = 0x00;
+    Sha256 ctx;
+    ctx.update(&prefix, 1);
+    ctx.update(data, size);
+    ctx.finish(digest);
+}
+
+}  // namespace
+
+void sha256(const uint8_t* data, size_t size, uint8_t digest[32]) {
+    Sha256 ctx;
+    ctx.update(data, size);
+    ctx.finish(digest);
+}
+
+void compute_build_id(const std::vector<uint8_t>& image, TaskScheduler& scheduler,
+                      uint8_t digest[BUILD_ID_SIZE]) {
+    const size_t leaf_count = (image.size() + BUILD_ID_LEAF_SIZE - 1) / BUILD_ID_LEAF_SIZE;
+    std::vector<uint8_t> leaves(leaf_count * 32);
+
+    // Each leaf digest lands in its own slot, so scheduling only affects speed
+    scheduler.parallel_for(leaf_count, 1, [&](size_t first, size_t last) {
+        for (size_t i = first; i < last; ++i) {
+            size_t offset = i * BUILD_ID_LEAF_SIZE;
+            size_t size = std::min(BUILD_ID_LEAF_SIZE, image.size() - offset);
+            hash_leaf(image.data() + offset, size, &leaves[i * 32]);
+        }
+    });
+
+    uint8_t header[9] = {0x01};
+    for (int i = 0; i < 8; ++i) {
+        header[1 + i] = static_cast<uint8_t>(static_cast<uint64_t>(image.size()) >> (8 * i));
+    }
+    Sha256 root;
+    root.update(header, sizeof(header));
+    root.update(leaves.data(), leaves.size());
+    root.finish(digest);
+}
+
+std::string build_id_hex(const uint8_t digest[BUILD_ID_SIZE]) {
+    static const char HEX[] = "0123456789abcdef";
+    std::string text;
+    for (size_t i = 0; i < BUILD_ID_SIZE; ++i) {
+        text += HEX[digest[i] >> 4];
+        text += HEX[digest[i] & 0xF];
+    }
+    return text;
+}
@@ -0,0 +1,85 @@
+#include "Checksum.h"
+
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <nmmintrin.h>
+#define MYCCLINKER_HAVE_SSE42_DISPATCH 1
+#endif
+
+namespace {
+
+const uint32_t CRC32C_POLY = 0x82F63B78;
+
+struct Crc32cTable {
+    uint32_t entries[256];
+
+    Crc32cTable() {
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t crc = i;
+            for (int bit = 0; bit < 8; ++bit) {
+                crc = (crc >> 1) ^ ((crc & 1) ? CRC32C_POLY : 0);
+            }
+            entries[i] = crc;
+        }
+    }
+};
+
+const Crc32cTable g_table;
+
+// With dst == nullptr only the CRC is computed.
+uint32_t update_table(uint32_t crc, uint8_t* dst, const uint8_t* src, size_t size) {
+    for (size_t i = 0; i < size; ++i) {
+        crc = g_table.entries[(crc ^ src[i]) & 0xFF] ^ (crc >> 8);
+    }
+    if (dst && size > 0) memcpy(dst, src, size);
+    return crc;
+}
+
+#ifdef MYCCLINKER_HAVE_SSE42_DISPATCH
+__attribute__((target("sse4.2")))
+uint32_t update_sse42(uint32_t crc, uint8_t* dst, const uint8_t* src, size_t size) {
+    size_t i = 0;
+#if defined(__x86_64__)
+    uint64_t crc64 = crc;
+    for (; i + 8 <= size; i += 8) {
+        uint64_t word;
+        memcpy(&word, src + i, sizeof(word));
+        crc64 = _mm_crc32_u64(crc64, word);
+        if (dst) memcpy(dst + i, &word, sizeof(word));
+    }
+    crc = static_cast<uint32_t>(crc64);
+#else
+    for (; i + 4 <= size; i += 4) {
+        uint32_t word;
+        memcpy(&word, src + i, sizeof(word));
+        crc = _mm_crc32_u32(crc, word);
+        if (dst) memcpy(dst + i, &word, sizeof(word));
+    }
+#endif
+    for (; i < size; ++i) {
+        crc = _mm_crc32_u8(crc, src[i]);
+        if (dst) dst[i] = src[i];
+    }
+    return crc;
+}
+
+const bool g_has_sse42 = __builtin_cpu_supports("sse4.2");
+#endif
+
+uint32_t update(uint32_t crc, uint8_t* dst, const uint8_t* src, size_t size) {
+#ifdef MYCCLINKER_HAVE_SSE42_DISPATCH
+    if (g_has_sse42) return update_sse42(crc, dst, src, size);
+#endif
+    return update_table(crc, dst, src, size);
+}
+
+}  // namespace
+
+uint32_t crc32c(const uint8_t* data, size_t size) {
+    return ~update(0xFFFFFFFFu, nullptr, data, size);
+}
+
+uint32_t crc32c_copy(uint8_t* dst, const uint8_t* src, size_t size) {
+    return ~update(0xFFFFFFFFu, dst, src, size);
+}
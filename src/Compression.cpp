@@ -0,0 +1,184 @@
+#include "Compression.h"
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+const size_t MIN_MATCH = 4;
+const size_t LAST_LITERALS = 5;  // The final 5 bytes are always literals
+const size_t MF_LIMIT = 12;      // No match may start in the final 12 bytes
+const size_t MAX_OFFSET = 65535;
+const int HASH_BITS = 14;
+
+inline uint32_t read32(const uint8_t* p) {
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+inline uint32_t hash4(uint32_t v) {
+    return (v * 2654435761u) >> (32 - HASH_BITS);
+}
+
+void write_length(std::vector<uint8_t>& out, size_t len) {
+    while (len >= 255) {
+        out.push_back(255);
+        len -= 255;
+    }
+    out.push_back(static_cast<uint8_t>(len));
+}
+
+void emit_sequence(std::vector<uint8_t>& out, const uint8_t* literals, size_t lit_len,
+                   size_t offset, size_t match_len) {
+    size_t ml = match_len ? match_len - MIN_MATCH : 0;
+    out.push_back(static_cast<uint8_t>((std::min<size_t>(lit_len, 15) << 4) |
+                                       std::min<size_t>(ml, 15)));
+    if (lit_len >= 15) write_length(out, lit_len - 15);
+    out.insert(out.end(), literals, literals + lit_len);
+    if (match_len) {
+        out.push_back(static_cast<uint8_t>(offset & 0xFF));
+        out.push_back(static_cast<uint8_t>(offset >> 8));
+        if (ml >= 15) write_length(out, ml - 15);
+    }
+}
+
+inline void copy16(uint8_t* dst, const uint8_t* src) {
+#if defined(__SSE2__)
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst),
+                     _mm_loadu_si128(reinterpret_cast<const __m128i*>(src)));
+#else
+    memcpy(dst, src, 16);
+#endif
+}
+
+// Copies `len` bytes in 16-byte strides. May write up to 15 bytes past
+// dst + len, so callers must guarantee that slack.
+inline void wild_copy(uint8_t* dst, const uint8_t* src, size_t len) {
+    uint8_t* const end = dst + len;
+    do {
+        copy16(dst, src);
+        dst += 16;
+        src += 16;
+    } while (dst < end);
+}
+
+// Reads an LZ4 length extension: bytes of 255 continue, anything less ends it.
+inline bool read_length(const uint8_t*& ip, const uint8_t* iend, size_t& len) {
+    uint8_t b;
+    do {
+        if (ip >= iend) return false;
+        b = *ip++;
+        len += b;
+    } while (b == 255);
+    return true;
+}
+
+}  // namespace
+
+size_t lz4_compress_bound(size_t src_size) {
+    return src_size + src_size / 255 + 16;
+}
+
+size_t lz4_compress_block(const uint8_t* src, size_t src_size, std::vector<uint8_t>& out) {
+    const size_t start_size = out.size();
+    if (src_size == 0) return 0;
+    out.reserve(start_size + lz4_compress_bound(src_size));
+
+    // Greedy parse with a single-entry hash table of recent 4-byte positions
+    std::vector<uint32_t> table(size_t{1} << HASH_BITS, UINT32_MAX);
+    size_t anchor = 0;
+    size_t i = 0;
+    const size_t limit = src_size > MF_LIMIT ? src_size - MF_LIMIT : 0;
+
+    while (i < limit) {
+        const uint32_t seq = read32(src + i);
+        const uint32_t h = hash4(seq);
+        const uint32_t cand = table[h];
+        table[h] = static_cast<uint32_t>(i);
+
+        if (cand == UINT32_MAX || i - cand > MAX_OFFSET || read32(src + cand) != seq) {
+            ++i;
+            continue;
+        }
+
+        size_t match_len = MIN_MATCH;
+        const size_t max_len = src_size - LAST_LITERALS - i;
+        while (match_len < max_len && src[cand + match_len] == src[i + match_len]) {
+            ++match_len;
+        }
+
+        emit_sequence(out, src + anchor, i - anchor, i - cand, match_len);
+        i += match_len;
+        anchor = i;
+    }
+
+    emit_sequence(out, src + anchor, src_size - anchor, 0, 0);
+    return out.size() - start_size;
+}
+
+bool lz4_decompress_block(const uint8_t* src, size_t src_size, uint8_t* dst, size_t dst_size) {
+    const uint8_t* ip = src;
+    const uint8_t* const iend = src + src_size;
+    uint8_t* op = dst;
+    uint8_t* const oend = dst + dst_size;
+
+    if (src_size == 0) {
+        return dst_size == 0;
+    }
+
+    while (ip < iend) {
+        const uint8_t token = *ip++;
+
+        // Literals
+        size_t lit_len = token >> 4;
+        if (lit_len == 15 && !read_length(ip, iend, lit_len)) return false;
+        if (lit_len > static_cast<size_t>(iend - ip) || lit_len > static_cast<size_t>(oend - op)) {
+            return false;
+        }
+        if (static_cast<size_t>(iend - ip) >= lit_len + 16 &&
+            static_cast<size_t>(oend - op) >= lit_len + 16) {
+            wild_copy(op, ip, lit_len);
+        } else {
+            memcpy(op, ip, lit_len);
+        }
+        op += lit_len;
+        ip += lit_len;
+
+        if (ip == iend) break;  // Last sequence: literals only
+
+        // Match
+        if (iend - ip < 2) return false;
+        const size_t offset = static_cast<size_t>(ip[0]) | (static_cast<size_t>(ip[1]) << 8);
+        ip += 2;
+        if (offset == 0 || offset > static_cast<size_t>(op - dst)) return false;
+
+        size_t match_len = token & 0x0F;
+        if (match_len == 15 && !read_length(ip, iend, match_len)) return false;
+        match_len += MIN_MATCH;
+        if (match_len > static_cast<size_t>(oend - op)) return false;
+
+        const uint8_t* match = op - offset;
+        if (offset >= 16 && static_cast<size_t>(oend - op) >= match_len + 16) {
+            // Source and destination 16-byte chunks never overlap
+            wild_copy(op, match, match_len);
+            op += match_len;
+        } else if (offset == 1) {
+            // Byte run, typically zero padding
+            memset(op, *match, match_len);
+            op += match_len;
+        } else {
+            // Overlapping run (offset < 16 repeats a short pattern) or near the end
+            for (size_t i = 0; i < match_len; ++i) {
+                op[i] = match[i];
+            }
+            op += match_len;
+        }
+    }
+
+    return op == oend;
+}
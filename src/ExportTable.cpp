@@ -0,0 +1,165 @@
+#include "ExportTable.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <set>
+#include <sstream>
+
+namespace {
+
+// Average keys per bucket. Lower means more seeds to store but a faster build.
+const uint32_t KEYS_PER_BUCKET = 2;
+const uint32_t MAX_SEED = 1u << 24;
+
+void put_be32(std::vector<uint8_t>& out, uint32_t offset, uint32_t value) {
+    out[offset + 0] = static_cast<uint8_t>((value >> 24) & 0xFF);
+    out[offset + 1] = static_cast<uint8_t>((value >> 16) & 0xFF);
+    out[offset + 2] = static_cast<uint8_t>((value >> 8) & 0xFF);
+    out[offset + 3] = static_cast<uint8_t>(value & 0xFF);
+}
+
+}  // namespace
+
+uint32_t export_hash(const char* name, uint32_t seed) {
+    uint32_t hash = 0x811C9DC5u ^ (seed * 0x9E3779B9u);
+    for (const char* p = name; *p; ++p) {
+        hash ^= static_cast<uint8_t>(*p);
+        hash *= 0x01000193u;
+    }
+    // Final avalanche so the low bits used by the modulo depend on every byte
+    hash ^= hash >> 16;
+    hash *= 0x85EBCA6Bu;
+    hash ^= hash >> 13;
+    return hash;
+}
+
+bool read_export_list(const std::string& path, std::vector<std::string>& names) {
+    std::ifstream file(path);
+    if (!file) {
+        std::cerr << "Error: Could not open export list " << path << std::endl;
+        return false;
+    }
+
+    std::set<std::string> seen;
+    std::string line;
+    while (std::getline(file, line)) {
+        size_t comment = line.find('#');
+        if (comment != std::string::npos) {
+            line.erase(comment);
+        }
+
+        std::istringstream iss(line);
+        std::string name;
+        while (iss >> name) {
+            if (!seen.insert(name).second) {
+                std::cerr << "Error: Symbol '" << name << "' listed twice in " << path << std::endl;
+                return false;
+            }
+            names.push_back(name);
+        }
+    }
+    return true;
+}
+
+bool build_export_table(const std::vector<std::string>& names, ExportTable& table) {
+    table = ExportTable();
+    if (names.empty()) {
+        std::cerr << "Error: Export table has no symbols" << std::endl;
+        return false;
+    }
+
+    uint32_t n = static_cast<uint32_t>(names.size());
+    uint32_t r = (n + KEYS_PER_BUCKET - 1) / KEYS_PER_BUCKET;
+
+    std::vector<std::vector<uint32_t>> buckets(r);
+    for (uint32_t i = 0; i < n; ++i) {
+        buckets[export_hash(names[i].c_str(), 0) % r].push_back(i);
+    }
+
+    // Largest buckets first, while most slots are still free
+    std::vector<uint32_t> order(r);
+    for (uint32_t b = 0; b < r; ++b) order[b] = b;
+    std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+        return buckets[a].size() > buckets[b].size();
+    });
+
+    table.seeds.assign(r, 0);
+    std::vector<int64_t> slot_key(n, -1);
+    std::vector<uint32_t> candidate;
+
+    for (uint32_t b : order) {
+        const auto& keys = buckets[b];
+        if (keys.empty()) break;  // Sorted, so the rest are empty too
+
+        bool placed = false;
+        for (uint32_t seed = 1; seed < MAX_SEED && !placed; ++seed) {
+            candidate.clear();
+            placed = true;
+            for (uint32_t key : keys) {
+                uint32_t slot = export_hash(names[key].c_str(), seed) % n;
+                if (slot_key[slot] >= 0 ||
+                    std::find(candidate.begin(), candidate.end(), slot) != candidate.end()) {
+                    placed = false;
+                    break;
+                }
+                candidate.push_back(slot);
+            }
+
+            if (placed) {
+                table.seeds[b] = seed;
+                for (size_t k = 0; k < keys.size(); ++k) {
+                    slot_key[candidate[k]] = keys[k];
+                }
+            }
+        }
+
+        if (!placed) {
+            std::cerr << "Error: Could not build a perfect hash for the export table" << std::endl;
+            return false;
+        }
+    }
+
+    uint32_t offset = 16 + 4 * r + 8 * n;
+    table.slots.resize(n);
+    table.name_offsets.resize(n);
+    for (uint32_t slot = 0; slot < n; ++slot) {
+        table.slots[slot] = names[slot_key[slot]];
+        table.name_offsets[slot] = offset;
+        offset += static_cast<uint32_t>(table.slots[slot].size()) + 1;
+    }
+    table.encoded_size = (offset + 3) & ~3u;
+    return true;
+}
+
+bool encode_export_table(const ExportTable& table,
+                         uint32_t table_addr,
+                         const SymbolTable& symbols,
+                         std::vector<uint8_t>& out) {
+    uint32_t n = static_cast<uint32_t>(table.slots.size());
+    uint32_t r = static_cast<uint32_t>(table.seeds.size());
+
+    out.assign(table.encoded_size, 0);
+    put_be32(out, 0, EXPORT_TABLE_MAGIC);
+    put_be32(out, 4, n);
+    put_be32(out, 8, r);
+
+    for (uint32_t b = 0; b < r; ++b) {
+        put_be32(out, 16 + 4 * b, table.seeds[b]);
+    }
+
+    uint32_t entries = 16 + 4 * r;
+    for (uint32_t slot = 0; slot < n; ++slot) {
+        const std::string& name = table.slots[slot];
+        const uint32_t* address = symbols.find(name);
+        if (!address) {
+            std::cerr << "Error: Exported symbol '" << name << "' is undefined" << std::endl;
+            return false;
+        }
+
+        put_be32(out, entries + 8 * slot, table_addr + table.name_offsets[slot]);
+        put_be32(out, entries + 8 * slot + 4, *address);
+        std::copy(name.begin(), name.end(), out.begin() + table.name_offsets[slot]);
+    }
+    return true;
+}
@@ -0,0 +1,120 @@
+#include "ImageFormat.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "Compression.h"
+
+void encode_compressed_image(const std::vector<uint8_t>& image,
+                             uint32_t image_base,
+                             uint32_t block_size,
+                             TaskScheduler& scheduler,
+                             std::vector<uint8_t>& out) {
+    const uint32_t image_size = static_cast<uint32_t>(image.size());
+    const uint32_t block_count = (image_size + block_size - 1) / block_size;
+
+    CompressedImageHeader header = CompressedImageHeader();
+    header.magic = COMPRESSED_IMAGE_MAGIC;
+    header.version = COMPRESSED_IMAGE_VERSION;
+    header.header_size = sizeof(CompressedImageHeader);
+    header.block_size = block_size;
+    header.block_count = block_count;
+    header.image_size = image_size;
+    header.image_base = image_base;
+
+    std::vector<CompressedBlockEntry> index(block_count);
+    const size_t index_end = sizeof(header) + index.size() * sizeof(CompressedBlockEntry);
+
+    // Compress every block into its own buffer, then lay them out in order
+    std::vector<std::vector<uint8_t>> payloads(block_count);
+    scheduler.parallel_for(block_count, 1, [&](size_t first, size_t last) {
+        for (size_t b = first; b < last; ++b) {
+            const uint8_t* block = image.data() + b * block_size;
+            const size_t raw_size = std::min<size_t>(block_size, image_size - b * block_size);
+
+            size_t written = lz4_compress_block(block, raw_size, payloads[b]);
+            if (written >= raw_size) {
+                // Incompressible: keep the raw bytes instead
+                payloads[b].assign(block, block + raw_size);
+                index[b].flags = IMAGE_BLOCK_STORED;
+            }
+            index[b].compressed_size = static_cast<uint32_t>(payloads[b].size());
+        }
+    });
+
+    size_t total = index_end;
+    for (const auto& payload : payloads) {
+        total += payload.size();
+    }
+    out.assign(index_end, 0);
+    out.reserve(total);
+    for (uint32_t b = 0; b < block_count; ++b) {
+        index[b].offset = static_cast<uint32_t>(out.size());
+        out.insert(out.end(), payloads[b].begin(), payloads[b].end());
+    }
+
+    memcpy(out.data(), &header, sizeof(header));
+    if (!index.empty()) {
+        memcpy(out.data() + sizeof(header), index.data(), index.size() * sizeof(CompressedBlockEntry));
+    }
+}
+
+size_t ImageSegments::file_offset(uint32_t address) const {
+    // The last segment starting at or below `address`
+    auto it = std::upper_bound(entries.begin(), entries.end(), address,
+                               [](uint32_t a, const ImageSegmentEntry& e) { return a < e.address; });
+    const ImageSegmentEntry& entry = *(it - 1);
+    return entry.offset + static_cast<size_t>(address - entry.address);
+}
+
+ImageSegments plan_image_segments(uint32_t image_base,
+                                  std::vector<std::pair<uint64_t, uint64_t>> extents) {
+    std::sort(extents.begin(), extents.end());
+
+    // The anchor is an empty extent at the base: if everything merges into
+    // it, the result is the flat dump
+    std::vector<std::pair<uint64_t, uint64_t>> merged;
+    merged.emplace_back(image_base, image_base);
+    for (const auto& extent : extents) {
+        if (extent.first <= merged.back().second + MAX_IMAGE_GAP) {
+            merged.back().second = std::max(merged.back().second, extent.second);
+        } else {
+            merged.push_back(extent);
+        }
+    }
+
+    ImageSegments segments;
+    segments.segmented = merged.size() > 1;
+    if (segments.segmented && merged.front().first == merged.front().second) {
+        merged.erase(merged.begin());  // Nothing stored near the base
+    }
+
+    size_t offset = 0;
+    if (segments.segmented) {
+        offset = sizeof(SegmentedImageHeader) + merged.size() * sizeof(ImageSegmentEntry);
+    }
+    for (const auto& range : merged) {
+        ImageSegmentEntry entry;
+        entry.address = static_cast<uint32_t>(range.first);
+        entry.size = static_cast<uint32_t>(range.second - range.first);
+        entry.offset = static_cast<uint32_t>(offset);
+        offset += entry.size;
+        segments.entries.push_back(entry);
+    }
+    segments.base = segments.entries.front().address;
+    segments.file_size = offset;
+    return segments;
+}
+
+void write_segment_table(const ImageSegments& segments, std::vector<uint8_t>& file) {
+    if (!segments.segmented) return;
+
+    SegmentedImageHeader header = SegmentedImageHeader();
+    header.magic = SEGMENTED_IMAGE_MAGIC;
+    header.version = SEGMENTED_IMAGE_VERSION;
+    header.header_size = sizeof(SegmentedImageHeader);
+    header.segment_count = static_cast<uint32_t>(segments.entries.size());
+    memcpy(file.data(), &header, sizeof(header));
+    memcpy(file.data() + sizeof(header), segments.entries.data(),
+           segments.entries.size() * sizeof(ImageSegmentEntry));
+}
@@ -0,0 +1,53 @@
+#include "ImageHandoff.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+bool create_image_memfd(const std::string& name, int& fd) {
+    // Not close-on-exec: the descriptor is meant to survive into the consumer
+    fd = memfd_create(("mllinker:" + name).c_str(), MFD_ALLOW_SEALING);
+    if (fd < 0) {
+        std::cerr << "Error: Could not create memfd: " << strerror(errno) << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool exec_with_image(int fd, const std::vector<std::string>& command) {
+    // The consumer gets a read-only view of exactly what was linked
+    if (fcntl(fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_WRITE | F_SEAL_SEAL) != 0) {
+        std::cerr << "Error: Could not seal the image memfd: " << strerror(errno) << std::endl;
+        return false;
+    }
+    if (lseek(fd, 0, SEEK_SET) != 0) {
+        std::cerr << "Error: Could not rewind the image memfd: " << strerror(errno) << std::endl;
+        return false;
+    }
+
+    const std::string fd_text = std::to_string(fd);
+    std::vector<std::string> args = command;
+    for (auto& arg : args) {
+        for (size_t pos = arg.find("{fd}"); pos != std::string::npos;
+             pos = arg.find("{fd}", pos + fd_text.size())) {
+            arg.replace(pos, 4, fd_text);
+        }
+    }
+    std::vector<char*> argv;
+    for (auto& arg : args) {
+        argv.push_back(&arg[0]);
+    }
+    argv.push_back(nullptr);
+
+    setenv("MLLINKER_IMAGE_FD", fd_text.c_str(), 1);
+    std::cout << std::flush;
+    std::cerr << std::flush;
+    execvp(argv[0], argv.data());
+    std::cerr << "Error: Could not run " << args[0] << ": " << strerror(errno) << std::endl;
+    return false;
+}
@@ -0,0 +1,86 @@
+#include "LibrarySearch.h"
+
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <mutex>
+
+namespace {
+
+std::mutex g_index_mutex;
+// unique_ptr keeps returned references stable while the map grows.
+std::map<std::string, std::unique_ptr<DirectoryIndex>> g_index_cache;
+
+std::unique_ptr<DirectoryIndex> scan_directory(const std::string& dir) {
+    namespace fs = std::filesystem;
+
+    auto index = std::make_unique<DirectoryIndex>();
+    index->path = dir;
+
+    std::error_code ec;
+    fs::directory_iterator it(dir, ec);
+    if (ec) {
+        return index;  // Missing or unreadable: cache the negative result too
+    }
+    index->exists = true;
+
+    for (const fs::directory_iterator end; it != end; it.increment(ec)) {
+        if (ec) break;
+        // directory_entry caches the d_type from readdir, so this does not stat
+        // on filesystems that report it.
+        std::error_code type_ec;
+        if (it->is_regular_file(type_ec) || it->is_symlink(type_ec)) {
+            index->entries.insert(it->path().filename().string());
+        }
+    }
+    return index;
+}
+
+std::string join_path(const std::string& dir, const std::string& file) {
+    if (dir.empty() || dir.back() == '/') {
+        return dir + file;
+    }
+    return dir + "/" + file;
+}
+
+}  // namespace
+
+const DirectoryIndex& get_directory_index(const std::string& dir) {
+    std::lock_guard<std::mutex> lock(g_index_mutex);
+    auto it = g_index_cache.find(dir);
+    if (it == g_index_cache.end()) {
+        it = g_index_cache.emplace(dir, scan_directory(dir)).first;
+    }
+    return *it->second;
+}
+
+void clear_directory_index_cache() {
+    std::lock_guard<std::mutex> lock(g_index_mutex);
+    g_index_cache.clear();
+}
+
+bool find_library(const std::vector<std::string>& search_dirs,
+                  const std::string& name,
+                  std::string& resolved_path) {
+    std::vector<std::string> candidates;
+    if (!name.empty() && name[0] == ':') {
+        candidates.push_back(name.substr(1));
+    } else {
+        candidates.push_back("lib" + name + ".obj");
+        candidates.push_back(name + ".obj");
+        candidates.push_back("lib" + name + ".lib");
+    }
+
+    for (const auto& dir : search_dirs) {
+        const DirectoryIndex& index = get_directory_index(dir);
+        if (!index.exists) continue;
+
+        for (const auto& candidate : candidates) {
+            if (index.entries.count(candidate)) {
+                resolved_path = join_path(dir, candidate);
+                return true;
+            }
+        }
+    }
+    return false;
+}
@@ -0,0 +1,45 @@
+#include "LinkContext.h"
+
+void LinkContext::reset(bool record_activations) {
+    resolver.reset(record_activations);
+    symbol_table.clear();
+    for (auto& obj : objects) {
+        recycle(obj);
+    }
+    objects.clear();
+    load_errors.clear();
+    image.clear();
+    compressed_image.clear();
+}
+
+TaskScheduler& LinkContext::scheduler(unsigned threads) {
+    if (!scheduler_ || scheduler_request_ != threads) {
+        scheduler_.reset();  // Join the old workers before starting new ones
+        scheduler_.reset(new TaskScheduler(threads));
+        scheduler_request_ = threads;
+    }
+    return *scheduler_;
+}
+
+UringReader* LinkContext::uring_reader() {
+    if (!reader_tried_) {
+        reader_tried_ = true;
+        std::unique_ptr<UringReader> reader(new UringReader());
+        if (reader->init()) reader_ = std::move(reader);
+    }
+    return reader_.get();
+}
+
+LoadedObject LinkContext::recycled_object() {
+    if (spare_objects_.empty()) {
+        return LoadedObject();
+    }
+    LoadedObject obj = std::move(spare_objects_.back());
+    spare_objects_.pop_back();
+    return obj;
+}
+
+void LinkContext::recycle(LoadedObject& obj) {
+    obj.clear();
+    spare_objects_.push_back(std::move(obj));
+}
@@ -0,0 +1,149 @@
+#include "LinkStats.h"
+
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+
+#include "JsonOutput.h"
+
+namespace {
+
+void write_sample(std::ostream& out, const PerfSample& sample) {
+    for (int e = 0; e < PERF_EVENT_COUNT; ++e) {
+        out << (e ? ", " : "") << "\"" << PERF_EVENT_NAMES[e] << "\": ";
+        if (sample.valid[e]) {
+            out << sample.values[e];
+        } else {
+            out << "null";
+        }
+    }
+}
+
+}  // namespace
+
+LinkStats::LinkStats(bool perf_counters, const std::vector<pid_t>& thread_ids) {
+    if (!perf_counters) {
+        perf_status_ = "off";
+        return;
+    }
+
+    int first_error = 0;
+    for (size_t t = 0; t < thread_ids.size(); ++t) {
+        auto counters = std::make_unique<ThreadCounters>();
+        int error = 0;
+        if (!counters->open(t == 0 ? current_thread_id() : thread_ids[t], error)) {
+            first_error = error;
+            counters_.clear();
+            break;
+        }
+        counters_.push_back(std::move(counters));
+    }
+
+    if (counters_.empty()) {
+        perf_status_ = std::string("unavailable: ") + strerror(first_error);
+        std::cerr << "Warning: --perf-counters: perf_event_open failed (" << strerror(first_error)
+                  << "); recording wall-clock times only" << std::endl;
+    } else {
+        perf_status_ = "ok";
+    }
+}
+
+void LinkStats::set(const std::string& key, uint64_t value) {
+    values_.emplace_back(key, value);
+}
+
+std::vector<PerfSample> LinkStats::sample_all() const {
+    std::vector<PerfSample> samples;
+    samples.reserve(counters_.size());
+    for (const auto& counters : counters_) {
+        samples.push_back(counters->read());
+    }
+    return samples;
+}
+
+void LinkStats::begin_phase(const char* name) {
+    end_phase();
+    PhaseRecord record;
+    record.name = name;
+    phases_.push_back(record);
+    phase_start_samples_ = sample_all();
+    phase_start_ = std::chrono::steady_clock::now();
+    in_phase_ = true;
+}
+
+void LinkStats::end_phase() {
+    if (!in_phase_) return;
+    in_phase_ = false;
+
+    auto end = std::chrono::steady_clock::now();
+    std::vector<PerfSample> end_samples = sample_all();
+
+    PhaseRecord& record = phases_.back();
+    record.wall_ms = std::chrono::duration<double, std::milli>(end - phase_start_).count();
+    for (size_t t = 0; t < end_samples.size(); ++t) {
+        PerfSample delta;
+        for (int e = 0; e < PERF_EVENT_COUNT; ++e) {
+            delta.valid[e] = end_samples[t].valid[e] && phase_start_samples_[t].valid[e];
+            if (delta.valid[e]) {
+                delta.values[e] = end_samples[t].values[e] - phase_start_samples_[t].values[e];
+            }
+        }
+        record.per_thread.push_back(delta);
+    }
+}
+
+bool LinkStats::write_json(const std::string& path) const {
+    std::ofstream out(path);
+    if (!out) {
+        std::cerr << "Error: Could not open stats file " << path << std::endl;
+        return false;
+    }
+
+    out << std::fixed << std::setprecision(3);
+    out << "{\n";
+    for (const auto& value : values_) {
+        out << "  ";
+        write_json_string(out, value.first);
+        out << ": " << value.second << ",\n";
+    }
+    out << "  \"perf_counters\": ";
+    write_json_string(out, perf_status_);
+    out << ",\n";
+
+    out << "  \"phases\": [";
+    for (size_t p = 0; p < phases_.size(); ++p) {
+        const PhaseRecord& phase = phases_[p];
+        out << (p ? "," : "") << "\n    {\"name\": ";
+        write_json_string(out, phase.name);
+        out << ", \"wall_ms\": " << phase.wall_ms;
+
+        if (!phase.per_thread.empty()) {
+            PerfSample total;
+            for (int e = 0; e < PERF_EVENT_COUNT; ++e) {
+                total.valid[e] = true;
+                for (const auto& sample : phase.per_thread) {
+                    total.valid[e] = total.valid[e] && sample.valid[e];
+                    total.values[e] += sample.values[e];
+                }
+            }
+            out << ",\n     \"total\": {";
+            write_sample(out, total);
+            out << "},\n     \"threads\": [";
+            for (size_t t = 0; t < phase.per_thread.size(); ++t) {
+                out << (t ? "," : "") << "\n       {\"thread\": " << t << ", ";
+                write_sample(out, phase.per_thread[t]);
+                out << "}";
+            }
+            out << "]";
+        }
+        out << "}";
+    }
+    out << "\n  ]\n}\n";
+
+    if (!out) {
+        std::cerr << "Error: Failed writing stats file " << path << std::endl;
+        return false;
+    }
+    return true;
+}
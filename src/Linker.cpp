@@ -1,159 +1,521 @@
 #include "Linker.h"
+#include "Archive.h"
+#include "BuildId.h"
+#include "ExportTable.h"
+#include "ImageFormat.h"
+#include "LibrarySearch.h"
+#include "LinkContext.h"
+#include "LinkStats.h"
+#include "MemoryRegions.h"
+#include "SharedImage.h"
+#include "SizeReport.h"
+#include "ObjectLoader.h"
+#include "SymbolResolver.h"
+#include "SymbolTable.h"
+#include "TaskScheduler.h"
 
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
 #include <cstring>
+#include <deque>
+#include <filesystem>
 #include <fstream>
 #include <iostream>
 #include <map>
+#include <memory>
 #include <set>
+#include <sstream>
+#include <thread>
+#include <unordered_map>
 #include <vector>
 
-namespace {
+void LoadedObject::clear() {
+    filename.clear();
+    header = FileHeader();
+    text_section.clear();
+    data_section.clear();
+    sdata_section.clear();
+    symbols.clear();
+    relocs.clear();
+    content_hash = 0;
+    text_base_addr = 0;
+    data_base_addr = 0;
+    sdata_base_addr = 0;
+    bss_base_addr = 0;
+    text_padding = 0;
+}
 
-bool load_object_file(const std::string& path, LoadedObject& obj) {
-    std::ifstream file(path, std::ios::binary);
-    if (!file) {
-        std::cerr << "Error: Could not open file " << path << std::endl;
-        return false;
+uint32_t section_size(const LoadedObject& obj, uint32_t section) {
+    switch (section) {
+        case SECTION_TEXT: return obj.header.text_size;
+        case SECTION_DATA: return obj.header.data_size;
+        case SECTION_SDATA: return obj.header.sdata_size;
+        case SECTION_BSS: return obj.header.bss_size;
     }
+    return 0;
+}
 
-    obj.filename = path;
+uint32_t section_base(const LoadedObject& obj, uint32_t section) {
+    switch (section) {
+        case SECTION_TEXT: return obj.text_base_addr;
+        case SECTION_DATA: return obj.data_base_addr;
+        case SECTION_SDATA: return obj.sdata_base_addr;
+        case SECTION_BSS: return obj.bss_base_addr;
+    }
+    return 0;
+}
+
+namespace {
+
+const char* const WRAP_PREFIX = "__wrap_";
+const char* const REAL_PREFIX = "__real_";
+
+// Content bytes per output section (alignment padding excluded)
+struct OutputSizes {
+    uint32_t text = 0;
+    uint32_t data = 0;
+    uint32_t sdata = 0;
+    uint32_t bss = 0;
+    uint32_t sdata_start = 0;  // Address of the first small-data byte
+    uint32_t bss_start = 0;    // [bss_start, bss_end) must be zeroed by startup code
+    uint32_t bss_end = 0;
+};
+
+// Symbols that give their name an address in this object
+bool is_definition(const SymbolEntry& sym) {
+    return sym.type == SYMBOL_DEFINED || sym.type == SYMBOL_WEAK;
+}
 
-    // Read Header
-    file.read(reinterpret_cast<char*>(&obj.header), sizeof(FileHeader));
-    if (obj.header.magic != LINKER_MAGIC) {
-        std::cerr << "Error: Invalid magic number in " << path << std::endl;
+// Names the linker defines itself in every link that asks for them. They
+// always mean this link's own, so they are neither exported nor imported.
+bool is_linker_owned_symbol(const std::string& name) {
+    return name == SDATA_BASE_SYMBOL || name == BSS_START_SYMBOL || name == BSS_END_SYMBOL ||
+           name == BUILD_ID_SYMBOL || name == EXPORT_TABLE_SYMBOL;
+}
+
+bool is_valid_alignment(uint32_t align) {
+    return (align & (align - 1)) == 0;  // 0 and 1 both mean "no constraint"
+}
+
+// Strictest alignment required for one object's section: the section's own
+// alignment, the alignment of every symbol it defines, and for text the
+// --align-functions minimum.
+bool section_alignment(const LoadedObject& obj,
+                       uint32_t section,
+                       uint32_t align_functions,
+                       uint32_t& align,
+                       std::ostream& err) {
+    switch (section) {
+        case SECTION_TEXT: align = obj.header.text_align; break;
+        case SECTION_DATA: align = obj.header.data_align; break;
+        case SECTION_SDATA: align = obj.header.sdata_align; break;
+        case SECTION_BSS: align = obj.header.bss_align; break;
+    }
+    if (section == SECTION_TEXT) {
+        align = std::max(align, align_functions);
+    }
+    if (!is_valid_alignment(align)) {
+        err << "Error: Section alignment " << align << " in " << obj.filename
+                  << " is not a power of two" << std::endl;
         return false;
     }
 
-    // Read Text Section
-    obj.text_section.resize(obj.header.text_size);
-    if (obj.header.text_size > 0) {
-        file.read(reinterpret_cast<char*>(obj.text_section.data()), obj.header.text_size);
-    }
+    for (const auto& sym : obj.symbols) {
+        if (!is_definition(sym) || sym.section != section || sym.align <= 1) continue;
 
-    // Read Data Section
-    obj.data_section.resize(obj.header.data_size);
-    if (obj.header.data_size > 0) {
-        file.read(reinterpret_cast<char*>(obj.data_section.data()), obj.header.data_size);
+        if (!is_valid_alignment(sym.align)) {
+            err << "Error: Alignment " << sym.align << " of symbol '" << sym.name
+                      << "' is not a power of two" << std::endl;
+            return false;
+        }
+        // The symbol moves with its section, so it can only be aligned if its
+        // offset already is.
+        if (sym.offset % sym.align != 0) {
+            err << "Error: Symbol '" << sym.name << "' at offset 0x" << std::hex << sym.offset
+                      << std::dec << " in " << obj.filename << " cannot be aligned to "
+                      << sym.align << " bytes" << std::endl;
+            return false;
+        }
+        align = std::max(align, sym.align);
     }
 
-    // Read Symbols
-    obj.symbols.resize(obj.header.symtable_count);
-    if (obj.header.symtable_count > 0) {
-        file.read(reinterpret_cast<char*>(obj.symbols.data()),
-                  obj.header.symtable_count * sizeof(SymbolEntry));
+    if (align == 0) align = 1;
+    return true;
+}
+
+// Rejects a non-empty section in a region whose access does not allow it
+bool check_region_access(const LoadedObject& obj,
+                         uint32_t section,
+                         const MemoryRegion& region,
+                         std::ostream& err) {
+    if (section_size(obj, section) == 0 || region.allows_section(section)) {
+        return true;
     }
+    const char* kind = section == SECTION_TEXT ? "text" : section == SECTION_DATA ? "data"
+                       : section == SECTION_SDATA ? "small data" : "BSS";
+    err << "Error: Cannot place " << kind << " of " << obj.filename << " in region '"
+        << region.name << "', which is not " << (section == SECTION_TEXT ? "executable" : "writable")
+        << std::endl;
+    return false;
+}
+
+// Picks the region for one object's section: a symbol placement rule for any
+// symbol the section defines wins over the rule for the section as a whole.
+bool select_region(const LoadedObject& obj,
+                   uint32_t section,
+                   const MemoryLayout& layout,
+                   size_t& region_index,
+                   std::ostream& err) {
+    bool found_symbol_rule = false;
+    for (const auto& sym : obj.symbols) {
+        if (!is_definition(sym) || sym.section != section) continue;
 
-    // Read Relocations
-    obj.relocs.resize(obj.header.reloc_count);
-    if (obj.header.reloc_count > 0) {
-        file.read(reinterpret_cast<char*>(obj.relocs.data()),
-                  obj.header.reloc_count * sizeof(RelocEntry));
+        auto rule = layout.symbol_region.find(sym.name);
+        if (rule == layout.symbol_region.end()) continue;
+
+        // Small data must stay one contiguous block around __sdata_base, and
+        // BSS one block between __bss_start and __bss_end
+        if (section == SECTION_SDATA || section == SECTION_BSS) {
+            err << "Error: Cannot place symbol '" << sym.name << "' individually; place "
+                      << (section == SECTION_SDATA ? ".sdata" : ".bss") << " as a whole"
+                      << std::endl;
+            return false;
+        }
+
+        if (found_symbol_rule && rule->second != region_index) {
+            err << "Error: Conflicting region placement for symbols in " << obj.filename
+                      << " ('" << sym.name << "' wants region '" << layout.regions[rule->second].name
+                      << "', an earlier symbol wants '" << layout.regions[region_index].name << "')"
+                      << std::endl;
+            return false;
+        }
+        region_index = rule->second;
+        found_symbol_rule = true;
     }
+    if (!found_symbol_rule) {
+        auto rule = layout.section_region.find(section);
+        region_index = (rule != layout.section_region.end()) ? rule->second : 0;
+    }
+    return check_region_access(obj, section, layout.regions[region_index], err);
+}
+
+// Objects per layout block. Fixed, so the work split never depends on the
+// thread count (the result does not either: the scan below is exact).
+const size_t LAYOUT_BLOCK_OBJECTS = 2048;
 
+// A run of consecutive objects in one region whose placement, once the run's
+// start is aligned to `align`, no longer depends on where the run starts:
+// every object in it needs at most `align`, and alignments are powers of two.
+struct LayoutLevel {
+    size_t region = 0;
+    uint32_t align = 1;
+    uint64_t length = 0;   // From the aligned start to the end of the last object
+    uint64_t start = 0;    // Aligned absolute start, filled by the serial pass
+    uint32_t padding = 0;  // Gap in front of `start`, filled by the serial pass
+};
+
+// Where one object's section lands, relative to its level
+struct Placement {
+    uint32_t level = 0;    // Index into its block's levels
+    uint64_t offset = 0;   // From the level start
+    uint32_t padding = 0;  // Gap in front of it (the level's, if it opens a level)
+    uint32_t size = 0;
+    bool opens_level = false;
+};
+
+// Pass 1 of the section scan for objects [begin, end): region and alignment
+// of each object, grouped into levels. A new level starts whenever an object
+// needs more alignment than the current level of its region guarantees, so a
+// block has at most one level per power of two per region.
+bool plan_layout_block(const std::vector<LoadedObject>& objects,
+                       size_t begin, size_t end,
+                       uint32_t section,
+                       const MemoryLayout& layout,
+                       uint32_t align_functions,
+                       std::vector<LayoutLevel>& levels,
+                       std::vector<Placement>& placements,
+                       std::ostream& err) {
+    std::vector<size_t> current(layout.regions.size(), SIZE_MAX);
+    for (size_t i = begin; i < end; ++i) {
+        const LoadedObject& obj = objects[i];
+        size_t region_index = 0;
+        uint32_t align = 1;
+        if (!select_region(obj, section, layout, region_index, err) ||
+            !section_alignment(obj, section, align_functions, align, err)) {
+            return false;
+        }
+
+        Placement& place = placements[i];
+        place = Placement();
+        place.size = section_size(obj, section);
+        size_t& level_index = current[region_index];
+        if (level_index == SIZE_MAX || align > levels[level_index].align) {
+            level_index = levels.size();
+            LayoutLevel level;
+            level.region = region_index;
+            level.align = align;
+            level.length = place.size;
+            levels.push_back(level);
+            place.opens_level = true;
+        } else {
+            LayoutLevel& level = levels[level_index];
+            uint64_t offset = (level.length + align - 1) & ~static_cast<uint64_t>(align - 1);
+            place.offset = offset;
+            place.padding = static_cast<uint32_t>(offset - level.length);
+            level.length = offset + place.size;
+        }
+        place.level = static_cast<uint32_t>(level_index);
+    }
     return true;
 }
 
-bool layout_and_define_symbols(std::vector<LoadedObject>& objects,
-                               std::map<std::string, uint32_t>& global_symbol_table,
-                               uint32_t& total_text_size,
-                               uint32_t& total_data_size) {
-    std::set<std::string> needed_symbols;
-    needed_symbols.insert("__START__");
-
-    std::vector<bool> object_active(objects.size(), false);
-    bool changed = true;
-
-    // Dependency Resolution Loop
-    while (changed) {
-        changed = false;
-        
-        // Pass 1: Activate objects that provide needed symbols
-        for (size_t i = 0; i < objects.size(); ++i) {
-            if (object_active[i]) continue; // Already active
-
-            for (const auto& sym : objects[i].symbols) {
-                if (sym.type == SYMBOL_DEFINED) {
-                    if (needed_symbols.count(sym.name)) {
-                        object_active[i] = true;
-                        changed = true;
-                        break; // Object is active, move to next object
-                    }
+// Places each object's sections into memory regions.
+// All text goes first, then all data, then all small data, so the default
+// single-region layout keeps text at 0 with data right after it.
+//
+// Each section is a prefix sum over object sizes with alignment. Blocks of
+// objects are planned in parallel (plan_layout_block), a serial pass chains
+// the few levels of every block onto the regions in order, and addresses are
+// then filled in parallel. This gives exactly the addresses of a serial
+// running sum.
+bool layout_sections(std::vector<LoadedObject>& objects,
+                     MemoryLayout& layout,
+                     uint32_t align_functions,
+                     TaskScheduler& scheduler,
+                     OutputSizes& sizes) {
+    sizes = OutputSizes();
+    for (auto& region : layout.regions) {
+        region.used = 0;
+    }
+
+    const size_t block_count = (objects.size() + LAYOUT_BLOCK_OBJECTS - 1) / LAYOUT_BLOCK_OBJECTS;
+    std::vector<std::vector<LayoutLevel>> block_levels(block_count);
+    std::vector<Placement> placements(objects.size());
+    std::vector<std::string> errors(block_count);
+
+    for (uint32_t section : {SECTION_TEXT, SECTION_DATA, SECTION_SDATA, SECTION_BSS}) {
+        // Pass 1: plan every block independently
+        std::vector<uint8_t> failed(block_count, 0);
+        scheduler.parallel_for(block_count, 1, [&](size_t first, size_t last) {
+            for (size_t b = first; b < last; ++b) {
+                size_t begin = b * LAYOUT_BLOCK_OBJECTS;
+                size_t end = std::min(objects.size(), begin + LAYOUT_BLOCK_OBJECTS);
+                block_levels[b].clear();
+                std::ostringstream err;
+                if (!plan_layout_block(objects, begin, end, section, layout, align_functions,
+                                       block_levels[b], placements, err)) {
+                    failed[b] = 1;
+                    errors[b] = err.str();
                 }
             }
+        });
+        for (size_t b = 0; b < block_count; ++b) {
+            if (failed[b]) {
+                std::cerr << errors[b];
+                return false;
+            }
         }
 
-        // Pass 2: Collect new needs from active objects
-        for (size_t i = 0; i < objects.size(); ++i) {
-            if (!object_active[i]) continue;
-
-            // Add all Defined symbols from this active object to 'needed' if they are used? 
-            // No, only add relocations.
-            // BUT, if an object is active, we might want to expose its symbols?
-            // The requirement "Scope is not narrowed down" implies we should ONLY expose needed symbols.
-            // So we don't blindly add all definitions to 'needed'.
-            
-            for (const auto& reloc : objects[i].relocs) {
-                if (needed_symbols.find(reloc.symbol_name) == needed_symbols.end()) {
-                    needed_symbols.insert(reloc.symbol_name);
-                    changed = true;
+        // Pass 2: chain the levels onto their regions, in object order
+        for (auto& levels : block_levels) {
+            for (auto& level : levels) {
+                MemoryRegion& region = layout.regions[level.region];
+                uint64_t cursor = region.origin + region.used;
+                level.start = (cursor + level.align - 1) & ~static_cast<uint64_t>(level.align - 1);
+                level.padding = static_cast<uint32_t>(level.start - cursor);
+                region.used += level.padding + level.length;
+            }
+        }
+
+        // Pass 3: final addresses, and per-block extents and totals
+        struct BlockExtent {
+            uint64_t start = UINT64_MAX;
+            uint64_t end = 0;
+            uint64_t size = 0;
+        };
+        std::vector<BlockExtent> extents(block_count);
+        scheduler.parallel_for(block_count, 1, [&](size_t first, size_t last) {
+            for (size_t b = first; b < last; ++b) {
+                size_t begin = b * LAYOUT_BLOCK_OBJECTS;
+                size_t end = std::min(objects.size(), begin + LAYOUT_BLOCK_OBJECTS);
+                BlockExtent& extent = extents[b];
+                for (size_t i = begin; i < end; ++i) {
+                    const Placement& place = placements[i];
+                    const LayoutLevel& level = block_levels[b][place.level];
+                    uint64_t aligned = level.start + place.offset;
+                    uint32_t addr = static_cast<uint32_t>(aligned);
+                    uint32_t padding = place.opens_level ? level.padding : place.padding;
+
+                    if (place.size > 0) {
+                        extent.start = std::min(extent.start, aligned);
+                        extent.end = std::max<uint64_t>(extent.end, aligned + place.size);
+                    }
+                    extent.size += place.size;
+
+                    LoadedObject& obj = objects[i];
+                    if (section == SECTION_TEXT) {
+                        obj.text_base_addr = addr;
+                        obj.text_padding = padding;
+                    } else if (section == SECTION_DATA) {
+                        obj.data_base_addr = addr;
+                    } else if (section == SECTION_SDATA) {
+                        obj.sdata_base_addr = addr;
+                    } else {
+                        obj.bss_base_addr = addr;
+                    }
                 }
             }
+        });
+
+        uint64_t section_start = UINT64_MAX;
+        uint64_t section_end = 0;
+        uint64_t total = 0;
+        for (const auto& extent : extents) {
+            section_start = std::min(section_start, extent.start);
+            section_end = std::max(section_end, extent.end);
+            total += extent.size;
+        }
+        switch (section) {
+            case SECTION_TEXT: sizes.text = static_cast<uint32_t>(total); break;
+            case SECTION_DATA: sizes.data = static_cast<uint32_t>(total); break;
+            case SECTION_SDATA: sizes.sdata = static_cast<uint32_t>(total); break;
+            case SECTION_BSS: sizes.bss = static_cast<uint32_t>(total); break;
+        }
+
+        if (section_end == 0) {
+            // Empty section: anchor its boundary symbols at the end of its region
+            auto rule = layout.section_region.find(section);
+            const MemoryRegion& region =
+                layout.regions[rule != layout.section_region.end() ? rule->second : 0];
+            section_start = section_end = region.origin + region.used;
+        }
+
+        if (section == SECTION_BSS) {
+            sizes.bss_start = static_cast<uint32_t>(section_start);
+            sizes.bss_end = static_cast<uint32_t>(section_end);
+        } else if (section == SECTION_SDATA) {
+            sizes.sdata_start = static_cast<uint32_t>(section_start);
+            if (section_end - section_start > SDATA_MAX_SIZE) {
+                std::cerr << "Error: Small data section is " << (section_end - section_start)
+                          << " bytes, more than the " << SDATA_MAX_SIZE
+                          << " reachable from " << SDATA_BASE_SYMBOL << std::endl;
+                return false;
+            }
         }
     }
 
-    // Filter objects to keep only active ones
-    std::vector<LoadedObject> active_objects;
-    for (size_t i = 0; i < objects.size(); ++i) {
-        if (object_active[i]) {
-            active_objects.push_back(std::move(objects[i]));
+    bool overflow = false;
+    for (const auto& region : layout.regions) {
+        if (region.used > region.length) {
+            std::cerr << "Error: Region '" << region.name << "' overflowed by "
+                      << (region.used - region.length) << " bytes (" << region.used << " used, "
+                      << region.length << " available)" << std::endl;
+            overflow = true;
         }
     }
-    objects = std::move(active_objects);
+    return !overflow;
+}
 
-    // Layout and Symbol Definition
-    uint32_t current_text_addr = 0;
-    total_text_size = 0;
-    total_data_size = 0;
+// Objects per block when definitions are sorted into symbol table shards
+const size_t DEFINE_BLOCK_OBJECTS = 256;
 
-    for (const auto& obj : objects) {
-        total_text_size += obj.header.text_size;
-        total_data_size += obj.header.data_size;
+// One definition headed for the symbol table, with its place on the link
+// line so a shard can be merged in exactly the order a serial pass uses
+struct Definition {
+    const SymbolEntry* sym;  // Symbols of one object are contiguous, so this orders within it
+    uint32_t object;
+    uint32_t address;
+};
+
+bool definition_before(const Definition& a, const Definition& b) {
+    return a.object != b.object ? a.object < b.object : a.sym < b.sym;
+}
+
+// Assigns final addresses to every needed symbol from the current layout.
+// Symbols imported from shared images keep the address they were linked at.
+//
+// Addresses are computed per block of objects in parallel and sorted by the
+// table shard of their name. Each shard is then merged on its own thread,
+// walking the blocks in order, strong definitions first and weak ones after,
+// so duplicates and weak precedence are decided exactly as in a serial pass.
+// A duplicate only ever collides within its shard; the earliest one on the
+// link line is reported.
+bool define_symbols(const std::vector<LoadedObject>& objects,
+                    const std::set<std::string>& needed_symbols,
+                    const std::map<std::string, uint32_t>& imports,
+                    const OutputSizes& sizes,
+                    TaskScheduler& scheduler,
+                    SymbolTable& global_symbol_table) {
+    global_symbol_table.clear();
+    for (const auto& symbol : imports) {
+        global_symbol_table.set(symbol.first, symbol.second);
     }
 
-    uint32_t current_data_addr = total_text_size;
+    // The base register points 32 KiB into .sdata so a signed 16-bit offset
+    // reaches the whole section.
+    global_symbol_table.set(SDATA_BASE_SYMBOL, sizes.sdata_start + SDATA_BASE_BIAS);
+    global_symbol_table.set(BSS_START_SYMBOL, sizes.bss_start);
+    global_symbol_table.set(BSS_END_SYMBOL, sizes.bss_end);
 
-    for (auto& obj : objects) {
-        obj.text_base_addr = current_text_addr;
-        obj.data_base_addr = current_data_addr;
-
-        current_text_addr += obj.header.text_size;
-        current_data_addr += obj.header.data_size;
-
-        for (const auto& sym : obj.symbols) {
-            if (sym.type == SYMBOL_DEFINED) {
-                // Only register if needed (Narrow Scope)
-                if (needed_symbols.count(sym.name)) {
-                     uint32_t final_addr = 0;
-                    if (sym.section == SECTION_TEXT) {
-                        final_addr = obj.text_base_addr + sym.offset;
-                    } else if (sym.section == SECTION_DATA) {
-                        final_addr = obj.data_base_addr + sym.offset;
-                    }
+    // Only needed symbols are registered (Narrow Scope)
+    const size_t shard_count = SymbolTable::SHARD_COUNT;
+    const size_t block_count = (objects.size() + DEFINE_BLOCK_OBJECTS - 1) / DEFINE_BLOCK_OBJECTS;
+    std::vector<std::vector<Definition>> buckets(block_count * shard_count);
+    scheduler.parallel_for(block_count, 1, [&](size_t begin, size_t end) {
+        for (size_t block = begin; block < end; ++block) {
+            size_t last = std::min(objects.size(), (block + 1) * DEFINE_BLOCK_OBJECTS);
+            for (size_t i = block * DEFINE_BLOCK_OBJECTS; i < last; ++i) {
+                const LoadedObject& obj = objects[i];
+                for (const auto& sym : obj.symbols) {
+                    if (!is_definition(sym) || !needed_symbols.count(sym.name)) continue;
+                    Definition def{&sym, static_cast<uint32_t>(i),
+                                   section_base(obj, sym.section) + sym.offset};
+                    buckets[block * shard_count + SymbolTable::shard_of(sym.name)].push_back(def);
+                }
+            }
+        }
+    });
 
-                    if (global_symbol_table.count(sym.name)) {
-                        std::cerr << "Error: Duplicate symbol definition '" << sym.name << "'" << std::endl;
-                        return false;
+    // Strong definitions, then weak ones filling whatever is still missing
+    // (first object wins). COMMON symbols arrive here as strong definitions
+    // in the linker's own BSS object.
+    std::vector<const Definition*> duplicates(shard_count, nullptr);
+    scheduler.parallel_for(shard_count, 1, [&](size_t begin, size_t end) {
+        for (size_t s = begin; s < end; ++s) {
+            SymbolTable::Shard& shard = global_symbol_table.shard(s);
+            for (size_t block = 0; block < block_count && !duplicates[s]; ++block) {
+                for (const auto& def : buckets[block * shard_count + s]) {
+                    if (def.sym->type != SYMBOL_DEFINED) continue;
+                    if (!shard.emplace(def.sym->name, def.address).second) {
+                        duplicates[s] = &def;
+                        break;
                     }
-                    global_symbol_table[sym.name] = final_addr;
+                }
+            }
+            if (duplicates[s]) continue;
+            for (size_t block = 0; block < block_count; ++block) {
+                for (const auto& def : buckets[block * shard_count + s]) {
+                    if (def.sym->type == SYMBOL_WEAK) shard.emplace(def.sym->name, def.address);
                 }
             }
         }
+    });
+
+    const Definition* duplicate = nullptr;
+    for (const Definition* def : duplicates) {
+        if (def && (!duplicate || definition_before(*def, *duplicate))) duplicate = def;
     }
-    
+    if (duplicate) {
+        std::cerr << "Error: Duplicate symbol definition '" << duplicate->sym->name << "'" << std::endl;
+        return false;
+    }
+
     // verify all needed symbols are found
     for (const auto& name : needed_symbols) {
-        if (global_symbol_table.find(name) == global_symbol_table.end()) {
+        if (!global_symbol_table.contains(name)) {
              std::cerr << "Error: Undefined symbol '" << name << "'" << std::endl;
              return false;
         }
@@ -162,204 +524,1160 @@ bool layout_and_define_symbols(std::vector<LoadedObject>& objects,
     return true;
 }
 
-bool apply_relocations(std::vector<LoadedObject>& objects,
-                       const std::map<std::string, uint32_t>& global_symbol_table) {
-    for (auto& obj : objects) {
-        for (const auto& reloc : obj.relocs) {
-            std::string sym_name(reloc.symbol_name);
+// Allocates every needed COMMON symbol without a strong definition in a
+// synthetic BSS-only object. Returns false if there is nothing to allocate.
+bool build_common_object(const std::map<std::string, CommonSymbol>& commons,
+                         const std::set<std::string>& strong_names,
+                         const std::set<std::string>& needed_symbols,
+                         LoadedObject& obj) {
+    obj = LoadedObject();
+    obj.filename = "<common>";
+    obj.header = FileHeader();
+    obj.header.bss_align = 1;
+
+    uint32_t offset = 0;
+    for (const auto& entry : commons) {
+        const std::string& name = entry.first;
+        if (strong_names.count(name) || !needed_symbols.count(name)) continue;
+
+        uint32_t align = std::max<uint32_t>(entry.second.align, 4);
+        offset = (offset + align - 1) & ~(align - 1);
+
+        SymbolEntry sym = SymbolEntry();
+        strncpy(sym.name, name.c_str(), sizeof(sym.name) - 1);
+        sym.type = SYMBOL_DEFINED;
+        sym.section = SECTION_BSS;
+        sym.offset = offset;
+        sym.size = entry.second.size;
+        obj.symbols.push_back(sym);
+
+        offset += entry.second.size;
+        obj.header.bss_align = std::max(obj.header.bss_align, align);
+    }
+
+    obj.header.bss_size = offset;
+    obj.header.symtable_count = static_cast<uint32_t>(obj.symbols.size());
+    return !obj.symbols.empty();
+}
+
+// Keeps the active objects, in order, at the front of `objects` and gives
+// the others to the context with their buffers. Swapping (rather than
+// moving over them) never frees a buffer.
+void drop_inactive_objects(std::vector<LoadedObject>& objects,
+                           const std::vector<bool>& object_active,
+                           LinkContext& context) {
+    size_t kept = 0;
+    for (size_t i = 0; i < objects.size(); ++i) {
+        if (i < object_active.size() && object_active[i]) {
+            if (kept != i) std::swap(objects[kept], objects[i]);
+            ++kept;
+        }
+    }
+    for (size_t i = kept; i < objects.size(); ++i) {
+        context.recycle(objects[i]);
+    }
+    objects.resize(kept);
+}
+
+bool layout_and_define_symbols(std::vector<LoadedObject>& objects,
+                               MemoryLayout& layout,
+                               uint32_t align_functions,
+                               const SymbolResolver& resolver,
+                               TaskScheduler& scheduler,
+                               SymbolTable& global_symbol_table,
+                               OutputSizes& sizes) {
+    const std::set<std::string>& needed_symbols = resolver.needed();
+
+    // Tentative definitions without a strong definition are merged into one
+    // linker-owned BSS object
+    LoadedObject common_object;
+    if (build_common_object(resolver.commons(), resolver.strong_names(), needed_symbols,
+                            common_object)) {
+        objects.push_back(std::move(common_object));
+    }
+
+    if (!layout_sections(objects, layout, align_functions, scheduler, sizes)) {
+        return false;
+    }
+
+    return define_symbols(objects, needed_symbols, resolver.imports(), sizes, scheduler,
+                          global_symbol_table);
+}
+
+// Deletes the instruction at `offset` from a relaxable object's text,
+// shrinks the symbol that contains it and shifts every later symbol and
+// relocation down by one word.
+void delete_text_word(LoadedObject& obj, uint32_t offset) {
+    obj.text_section.erase(obj.text_section.begin() + offset,
+                           obj.text_section.begin() + offset + 4);
+    obj.header.text_size -= 4;
+
+    for (auto& sym : obj.symbols) {
+        if (!is_definition(sym) || sym.section != SECTION_TEXT) continue;
+        if (sym.offset > offset) {
+            sym.offset -= 4;
+        } else if (offset - sym.offset < sym.size) {
+            // The symbol that contains the branch loses the bytes it covered
+            sym.size -= std::min<uint32_t>(4, sym.size - (offset - sym.offset));
+        }
+    }
+
+    std::vector<RelocEntry> kept;
+    kept.reserve(obj.relocs.size());
+    for (auto reloc : obj.relocs) {
+        if (reloc.offset == offset) continue;  // The deleted branch's own relocation
+        if (reloc.offset > offset) {
+            reloc.offset -= 4;
+        }
+        kept.push_back(reloc);
+    }
+    obj.relocs = std::move(kept);
+}
+
+// A site can go only if removing a word in front of an aligned text symbol
+// would not break that symbol's alignment.
+bool deletion_keeps_alignment(const LoadedObject& obj, uint32_t offset) {
+    for (const auto& sym : obj.symbols) {
+        if (is_definition(sym) && sym.section == SECTION_TEXT && sym.offset > offset &&
+            sym.align > 4) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Link-time relaxation on the final layout. In objects flagged
+// OBJ_FLAG_RELAXABLE, BRANCH26 sites whose target is the next instruction are
+// deleted. Layout and symbol addresses are then recomputed, and the pass
+// repeats until nothing changes, since each deletion can turn another branch
+// into a branch-to-next.
+bool relax_branches(std::vector<LoadedObject>& objects,
+                    MemoryLayout& layout,
+                    uint32_t align_functions,
+                    const std::set<std::string>& needed_symbols,
+                    const std::map<std::string, uint32_t>& imports,
+                    TaskScheduler& scheduler,
+                    SymbolTable& global_symbol_table,
+                    OutputSizes& sizes,
+                    std::ostream& log) {
+    size_t total_deleted = 0;
+    size_t passes = 0;
+
+    while (true) {
+        ++passes;
+        size_t deleted = 0;
+
+        for (auto& obj : objects) {
+            if (!(obj.header.flags & OBJ_FLAG_RELAXABLE)) continue;
 
-            if (global_symbol_table.find(sym_name) == global_symbol_table.end()) {
-                std::cerr << "Error: Undefined symbol '" << sym_name << "' referenced in "
-                          << obj.filename << std::endl;
+            std::vector<uint32_t> sites;
+            for (const auto& reloc : obj.relocs) {
+                if (reloc.type != RELOC_BRANCH26) continue;
+
+                const uint32_t* target = global_symbol_table.find(reloc.symbol_name);
+                if (!target) continue;  // Reported later
+
+                uint32_t next_addr = obj.text_base_addr + reloc.offset + 4;
+                if (*target == next_addr && reloc.offset + 4 <= obj.text_section.size() &&
+                    deletion_keeps_alignment(obj, reloc.offset)) {
+                    sites.push_back(reloc.offset);
+                }
+            }
+
+            // Highest offset first so earlier sites keep their offsets
+            std::sort(sites.rbegin(), sites.rend());
+            sites.erase(std::unique(sites.begin(), sites.end()), sites.end());
+            for (uint32_t offset : sites) {
+                delete_text_word(obj, offset);
+            }
+            deleted += sites.size();
+        }
+
+        if (deleted == 0) break;
+        total_deleted += deleted;
+
+        if (!layout_sections(objects, layout, align_functions, scheduler, sizes) ||
+            !define_symbols(objects, needed_symbols, imports, sizes, scheduler, global_symbol_table)) {
+            return false;
+        }
+    }
+
+    log << "Relaxation: removed " << total_deleted << " branch"
+              << (total_deleted == 1 ? "" : "es") << " in " << passes << " pass"
+              << (passes == 1 ? "" : "es") << std::endl;
+    return true;
+}
+
+bool apply_object_relocations(LoadedObject& obj,
+                              const SymbolTable& global_symbol_table,
+                              std::ostream& err) {
+    // LO16 halves by offset, to check that every HI16 has its partner
+    std::map<uint32_t, const RelocEntry*> lo16_at;
+    for (const auto& reloc : obj.relocs) {
+        if (reloc.type == RELOC_LO16) {
+            lo16_at[reloc.offset] = &reloc;
+        }
+    }
+
+    for (const auto& reloc : obj.relocs) {
+        std::string sym_name(reloc.symbol_name);
+
+        if (reloc.type > RELOC_BRANCH26) {
+            err << "Error: Unknown relocation type " << reloc.type << " in "
+                      << obj.filename << std::endl;
+            return false;
+        }
+
+        if (reloc.type == RELOC_HI16) {
+            auto lo = lo16_at.find(reloc.offset + 4);
+            if (lo == lo16_at.end() ||
+                strncmp(lo->second->symbol_name, reloc.symbol_name, sizeof(reloc.symbol_name)) != 0) {
+                err << "Error: HI16 relocation for '" << sym_name << "' at offset 0x"
+                          << std::hex << reloc.offset << std::dec << " in " << obj.filename
+                          << " has no matching LO16 in the next instruction" << std::endl;
                 return false;
             }
+        }
 
-            uint32_t target_addr = global_symbol_table.at(sym_name);
-            uint32_t patch_offset = reloc.offset; // Offset within this file's TEXT section
+        const uint32_t* target = global_symbol_table.find(sym_name);
+        if (!target) {
+            err << "Error: Undefined symbol '" << sym_name << "' referenced in "
+                      << obj.filename << std::endl;
+            return false;
+        }
+
+        uint32_t target_addr = *target;
+        uint32_t patch_offset = reloc.offset; // Offset within this file's TEXT section
+
+        // Check bounds
+        if (patch_offset + 4 > obj.text_section.size()) {
+            err << "Error: Relocation offset out of bounds in " << obj.filename
+                      << std::endl;
+            return false;
+        }
+
+        // Calculate value to write
+        uint32_t value_to_write = 0;
+        uint32_t instruction_addr = obj.text_base_addr + patch_offset;
+
+        if (reloc.type == RELOC_ABSOLUTE || reloc.type == RELOC_HI16 ||
+            reloc.type == RELOC_LO16) {
+            value_to_write = target_addr;
+        } else if (reloc.type == RELOC_SDA16) {
+            int64_t offset = static_cast<int64_t>(target_addr) -
+                             *global_symbol_table.find(SDATA_BASE_SYMBOL);
+            if (offset < INT16_MIN || offset > INT16_MAX) {
+                err << "Error: Small-data relocation to '" << sym_name << "' in "
+                          << obj.filename << " is out of range of " << SDATA_BASE_SYMBOL
+                          << " (offset " << offset << ")" << std::endl;
+                return false;
+            }
+            value_to_write = static_cast<uint32_t>(offset);
+        } else if (reloc.type == RELOC_RELATIVE || reloc.type == RELOC_BRANCH26) {
+            // Relative Jump: follow assembler's encoding, which uses (target - currentPC)
+            int32_t offset = target_addr - instruction_addr;
+
+            // Mask to 26 bits (signed) if necessary, but we write 32 bits into the slot usually?
+            // Wait, if it's a 26-bit jump instruction, we need to mask and merge.
+            // The design doc says: "Write the value into the corresponding 'hole' in the binary buffer."
+            // It doesn't specify instruction format details deeply.
+            // Assuming the hole is 32-bit for now or we just overwrite the field.
+            // CAUTION: If it's a partial instruction overwrite (like `B label`), we need to preserve opcode.
+            // BUT, Design doc Section 4 says: "leave a placeholder (0) in the machine code".
+            // If the assembler leaves 0, does it leave the opcode?
+            // If the assembler leaves 0 for the *whole instruction*, that's bad.
+            // A typical linkable object for a RISC arch usually has the opcode present and the immediate field 0.
+
+            // Let's assume the assembler leaves the opcode valid and the immediate 0.
+            // We need to read the existing instruction to preserve opcode?
+            // Or maybe the 'hole' is just the immediate field?
+            // The Design doc implies simple patching.
+            // "Write the value into the corresponding 'hole' in the binary buffer."
+            // "RelocEntry: uint32_t offset; // Offset in the TEXT section to patch"
+
+            // If the relocation type is RELATIVE, it's likely a Jump/Branch.
+            // If the "hole" is the full 32-bit word, we might destroy the opcode.
+            // However, without more instruction set details, I can't do bit-masking safely.
+            // BUT, looking at `MyAssembler`, let's see how `B` (Branch) is encoded.
+            // This is critical.
+
+            // Let's defer this specific bit-masking logic and assume for "Minimal" version:
+            // We read the 32-bit word, keep the top 6 bits (opcode?), and replace the bottom 26.
+            // Or maybe the RelocEntry assumes the assembler emitted a dummy instruction?
+            // No, "leave a placeholder (0)".
 
-            // Check bounds
-            if (patch_offset + 4 > obj.text_section.size()) {
-                std::cerr << "Error: Relocation offset out of bounds in " << obj.filename
+            // Strategy: Read current 32-bit word.
+            // If RELOC_RELATIVE, assume it's a specific format (e.g. top 6 bits opcode, bottom 26 offset).
+            // MyComputer Architecture v3.1 confirmation needed.
+            // Since I can't read the architecture spec easily (it's in `docs/spec.md`?), I should check it.
+            // But for now, I will assume a standard mask: 0xFC000000 is opcode, 0x03FFFFFF is offset.
+
+            uint32_t current_inst = 0;
+            memcpy(&current_inst, &obj.text_section[patch_offset], 4);
+            (void)current_inst;
+
+            // Mask: Keep top 6 bits, replace bottom 26
+            // This is a guess. I should verify with `docs/spec.md` if possible,
+            // but for a "quick" minimal implementation, this is a reasonable assumption
+            // for a custom 32-bit RISC.
+
+            // Also, relative offset is usually in words (instruction count) or bytes?
+            // ARM uses words (offset >> 2). x86 uses bytes.
+            // Design doc: "TargetAddress - (InstructionAddress + 4)" -> This is a byte difference.
+            // If the instruction expects a value in bytes, we are good.
+            // If it expects words, we need to shift.
+
+            // Let's stick to the raw value for now, or check `instructions.h` in MyAssembler if I could.
+            // I will add a TODO or just do a direct overwrite if the file says "placeholder (0)".
+            // If placeholder is 0, then `current_inst` might be just the opcode?
+
+            // Let's read `docs/spec.md` quickly to be safe?
+            // No, let's just implement a generic "OR" patch for now.
+            // value_to_write = (current_inst & 0xFC000000) | (offset & 0x03FFFFFF);
+
+            // Actually, let's just write the 32-bit value for ABSOLUTE.
+            // For RELATIVE, let's assume the assembler handled the opcode and we just OR in the offset.
+            // But `offset` is signed.
+
+            value_to_write = offset;
+            // We will OR it with existing content later.
+        }
+
+        // Apply patch
+        // We need to read existing to preserve bits if it's not a full overwrite
+        // Handle Big Endian read/write manually to avoid host endianness issues
+        uint8_t* ptr = &obj.text_section[patch_offset];
+        uint32_t existing = (static_cast<uint32_t>(ptr[0]) << 24) |
+                            (static_cast<uint32_t>(ptr[1]) << 16) |
+                            (static_cast<uint32_t>(ptr[2]) << 8)  |
+                            static_cast<uint32_t>(ptr[3]);
+
+        uint32_t final_val = 0;
+
+        if (reloc.type == RELOC_RELATIVE || reloc.type == RELOC_BRANCH26) {
+            // Regions can put caller and callee far apart; refuse to truncate.
+            int32_t offset = static_cast<int32_t>(value_to_write);
+            if (offset < -(1 << 25) || offset >= (1 << 25)) {
+                err << "Error: Relative relocation to '" << sym_name << "' in "
+                          << obj.filename << " out of 26-bit range (offset " << offset << ")"
                           << std::endl;
                 return false;
             }
 
-            // Calculate value to write
-            uint32_t value_to_write = 0;
-            uint32_t instruction_addr = obj.text_base_addr + patch_offset;
-
-            if (reloc.type == RELOC_ABSOLUTE) {
-                value_to_write = target_addr;
-            } else if (reloc.type == RELOC_RELATIVE) {
-                // Relative Jump: follow assembler's encoding, which uses (target - currentPC)
-                int32_t offset = target_addr - instruction_addr;
-
-                // Mask to 26 bits (signed) if necessary, but we write 32 bits into the slot usually?
-                // Wait, if it's a 26-bit jump instruction, we need to mask and merge.
-                // The design doc says: "Write the value into the corresponding 'hole' in the binary buffer."
-                // It doesn't specify instruction format details deeply.
-                // Assuming the hole is 32-bit for now or we just overwrite the field.
-                // CAUTION: If it's a partial instruction overwrite (like `B label`), we need to preserve opcode.
-                // BUT, Design doc Section 4 says: "leave a placeholder (0) in the machine code".
-                // If the assembler leaves 0, does it leave the opcode?
-                // If the assembler leaves 0 for the *whole instruction*, that's bad.
-                // A typical linkable object for a RISC arch usually has the opcode present and the immediate field 0.
-
-                // Let's assume the assembler leaves the opcode valid and the immediate 0.
-                // We need to read the existing instruction to preserve opcode?
-                // Or maybe the 'hole' is just the immediate field?
-                // The Design doc implies simple patching.
-                // "Write the value into the corresponding 'hole' in the binary buffer."
-                // "RelocEntry: uint32_t offset; // Offset in the TEXT section to patch"
-
-                // If the relocation type is RELATIVE, it's likely a Jump/Branch.
-                // If the "hole" is the full 32-bit word, we might destroy the opcode.
-                // However, without more instruction set details, I can't do bit-masking safely.
-                // BUT, looking at `MyAssembler`, let's see how `B` (Branch) is encoded.
-                // This is critical.
-
-                // Let's defer this specific bit-masking logic and assume for "Minimal" version:
-                // We read the 32-bit word, keep the top 6 bits (opcode?), and replace the bottom 26.
-                // Or maybe the RelocEntry assumes the assembler emitted a dummy instruction?
-                // No, "leave a placeholder (0)".
-
-                // Strategy: Read current 32-bit word.
-                // If RELOC_RELATIVE, assume it's a specific format (e.g. top 6 bits opcode, bottom 26 offset).
-                // MyComputer Architecture v3.1 confirmation needed.
-                // Since I can't read the architecture spec easily (it's in `docs/spec.md`?), I should check it.
-                // But for now, I will assume a standard mask: 0xFC000000 is opcode, 0x03FFFFFF is offset.
-
-                uint32_t current_inst = 0;
-                memcpy(&current_inst, &obj.text_section[patch_offset], 4);
-                (void)current_inst;
-
-                // Mask: Keep top 6 bits, replace bottom 26
-                // This is a guess. I should verify with `docs/spec.md` if possible,
-                // but for a "quick" minimal implementation, this is a reasonable assumption
-                // for a custom 32-bit RISC.
-
-                // Also, relative offset is usually in words (instruction count) or bytes?
-                // ARM uses words (offset >> 2). x86 uses bytes.
-                // Design doc: "TargetAddress - (InstructionAddress + 4)" -> This is a byte difference.
-                // If the instruction expects a value in bytes, we are good.
-                // If it expects words, we need to shift.
-
-                // Let's stick to the raw value for now, or check `instructions.h` in MyAssembler if I could.
-                // I will add a TODO or just do a direct overwrite if the file says "placeholder (0)".
-                // If placeholder is 0, then `current_inst` might be just the opcode?
-
-                // Let's read `docs/spec.md` quickly to be safe?
-                // No, let's just implement a generic "OR" patch for now.
-                // value_to_write = (current_inst & 0xFC000000) | (offset & 0x03FFFFFF);
-
-                // Actually, let's just write the 32-bit value for ABSOLUTE.
-                // For RELATIVE, let's assume the assembler handled the opcode and we just OR in the offset.
-                // But `offset` is signed.
-
-                value_to_write = offset;
-                // We will OR it with existing content later.
+            // Preserving top 6 bits (Opcode) - Assumption based on typical custom CPU
+            // And assuming the offset field is the lower 26 bits.
+            // Check if offset fits in 26 bits?
+            // (offset & ~0x03FFFFFF) should be 0 or all 1s.
+            final_val = (existing & 0xFC000000) | (value_to_write & 0x03FFFFFF);
+        } else if (reloc.type == RELOC_HI16) {
+            // The paired LO16 immediate is sign-extended when added, so
+            // borrow one from the upper half whenever bit 15 is set.
+            uint32_t hi = ((value_to_write + 0x8000) >> 16) & 0xFFFF;
+            final_val = (existing & 0xFFFF0000) | hi;
+        } else if (reloc.type == RELOC_LO16 || reloc.type == RELOC_SDA16) {
+            final_val = (existing & 0xFFFF0000) | (value_to_write & 0xFFFF);
+        } else {
+            // RELOC_ABSOLUTE
+            // Usually for data pointers (LDR R1, =Label).
+            // This often replaces the whole immediate/address word?
+            // Or is it a `MOV R1, Imm`?
+            // If it's a 32-bit absolute pointer in a data section or a literal pool, it's a full overwrite.
+            // If it's an instruction trying to load a 32-bit immediate, it might be complex.
+            // Let's assume full overwrite for Absolute for now (simplest for "Minimal").
+            final_val = value_to_write;
+        }
+
+        // Write back in Big Endian
+        ptr[0] = static_cast<uint8_t>((final_val >> 24) & 0xFF);
+        ptr[1] = static_cast<uint8_t>((final_val >> 16) & 0xFF);
+        ptr[2] = static_cast<uint8_t>((final_val >> 8) & 0xFF);
+        ptr[3] = static_cast<uint8_t>(final_val & 0xFF);
+    }
+
+    return true;
+}
+
+// What the output file stores: per region in use, from the region's origin
+// to its last byte of text, data or small data. BSS is not stored, so
+// trailing BSS does not grow the file. Regions far apart become separate
+// segments instead of being joined by zeros (plan_image_segments).
+ImageSegments plan_image(const std::vector<LoadedObject>& objects, const MemoryLayout& layout) {
+    std::vector<uint64_t> stored_end(layout.regions.size(), 0);
+    for (const auto& obj : objects) {
+        for (uint32_t section : {SECTION_TEXT, SECTION_DATA, SECTION_SDATA}) {
+            // Text alignment padding is stored too: it holds the fill word
+            uint32_t padding = section == SECTION_TEXT ? obj.text_padding : 0;
+            uint64_t start = section_base(obj, section) - padding;
+            uint64_t size = section_size(obj, section) + uint64_t{padding};
+            if (size == 0) continue;
+            for (size_t r = 0; r < layout.regions.size(); ++r) {
+                const MemoryRegion& region = layout.regions[r];
+                if (start >= region.origin && start < region.origin + region.length) {
+                    stored_end[r] = std::max(stored_end[r], start + size);
+                    break;
+                }
             }
+        }
+    }
 
-            // Apply patch
-            // We need to read existing to preserve bits if it's not a full overwrite
-            // Handle Big Endian read/write manually to avoid host endianness issues
-            uint8_t* ptr = &obj.text_section[patch_offset];
-            uint32_t existing = (static_cast<uint32_t>(ptr[0]) << 24) |
-                                (static_cast<uint32_t>(ptr[1]) << 16) |
-                                (static_cast<uint32_t>(ptr[2]) << 8)  |
-                                static_cast<uint32_t>(ptr[3]);
-
-            uint32_t final_val = 0;
-
-            if (reloc.type == RELOC_RELATIVE) {
-                // Preserving top 6 bits (Opcode) - Assumption based on typical custom CPU
-                // And assuming the offset field is the lower 26 bits.
-                // Check if offset fits in 26 bits?
-                // (offset & ~0x03FFFFFF) should be 0 or all 1s.
-                final_val = (existing & 0xFC000000) | (value_to_write & 0x03FFFFFF);
-            } else {
-                // RELOC_ABSOLUTE
-                // Usually for data pointers (LDR R1, =Label).
-                // This often replaces the whole immediate/address word?
-                // Or is it a `MOV R1, Imm`?
-                // If it's a 32-bit absolute pointer in a data section or a literal pool, it's a full overwrite.
-                // If it's an instruction trying to load a 32-bit immediate, it might be complex.
-                // Let's assume full overwrite for Absolute for now (simplest for "Minimal").
-                final_val = value_to_write;
+    std::vector<std::pair<uint64_t, uint64_t>> extents;
+    for (size_t r = 0; r < layout.regions.size(); ++r) {
+        if (stored_end[r] != 0) extents.emplace_back(layout.regions[r].origin, stored_end[r]);
+    }
+    return plan_image_segments(layout.image_base(), extents);
+}
+
+// Copies one object's sections (and the padding in front of its text) into
+// the image. Objects occupy disjoint ranges.
+void copy_object_to_image(const LoadedObject& obj, const ImageSegments& segments,
+                          uint32_t text_fill, std::vector<uint8_t>& image) {
+    // Alignment gap in front of this object's text: whole fill words, then
+    // zero bytes for any odd remainder (data gaps stay zero).
+    uint8_t* pad = obj.text_padding == 0 ? nullptr
+                   : image.data() + segments.file_offset(obj.text_base_addr - obj.text_padding);
+    for (uint32_t i = 0; i + 4 <= obj.text_padding; i += 4) {
+        pad[i + 0] = static_cast<uint8_t>((text_fill >> 24) & 0xFF);
+        pad[i + 1] = static_cast<uint8_t>((text_fill >> 16) & 0xFF);
+        pad[i + 2] = static_cast<uint8_t>((text_fill >> 8) & 0xFF);
+        pad[i + 3] = static_cast<uint8_t>(text_fill & 0xFF);
+    }
+
+    if (!obj.text_section.empty()) {
+        memcpy(&image[segments.file_offset(obj.text_base_addr)], obj.text_section.data(),
+               obj.text_section.size());
+    }
+    if (!obj.data_section.empty()) {
+        memcpy(&image[segments.file_offset(obj.data_base_addr)], obj.data_section.data(),
+               obj.data_section.size());
+    }
+    if (!obj.sdata_section.empty()) {
+        memcpy(&image[segments.file_offset(obj.sdata_base_addr)], obj.sdata_section.data(),
+               obj.sdata_section.size());
+    }
+}
+
+// Pass 2 + 3a: patch each object and copy it into the image. Objects are
+// independent and own disjoint image ranges, so they are spread over the
+// scheduler. Errors are buffered per object and the first one in link order
+// is reported, as a serial link would.
+bool relocate_into_image(std::vector<LoadedObject>& objects,
+                         const SymbolTable& global_symbol_table,
+                         const ImageSegments& segments,
+                         uint32_t text_fill,
+                         TaskScheduler& scheduler,
+                         std::vector<uint8_t>& image) {
+    image.assign(segments.file_size, 0);
+    write_segment_table(segments, image);
+
+    std::vector<std::string> errors(objects.size());
+    std::vector<uint8_t> failed(objects.size(), 0);
+    scheduler.parallel_for(objects.size(), 1, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            std::ostringstream err;
+            if (!apply_object_relocations(objects[i], global_symbol_table, err)) {
+                failed[i] = 1;
+                errors[i] = err.str();
+                continue;
             }
+            copy_object_to_image(objects[i], segments, text_fill, image);
+        }
+    });
 
-            // Write back in Big Endian
-            ptr[0] = static_cast<uint8_t>((final_val >> 24) & 0xFF);
-            ptr[1] = static_cast<uint8_t>((final_val >> 16) & 0xFF);
-            ptr[2] = static_cast<uint8_t>((final_val >> 8) & 0xFF);
-            ptr[3] = static_cast<uint8_t>(final_val & 0xFF);
+    for (size_t i = 0; i < objects.size(); ++i) {
+        if (failed[i]) {
+            std::cerr << errors[i];
+            return false;
         }
     }
-
     return true;
 }
 
-bool write_output(const std::string& output_path,
+// Hashes the finished image and stores the digest at __build_id. The slot
+// is still zero from the object's data, which is what the hash covers.
+void stamp_build_id(const std::vector<LoadedObject>& objects,
+                    const ImageSegments& segments,
+                    TaskScheduler& scheduler,
+                    std::vector<uint8_t>& image,
+                    uint8_t digest[BUILD_ID_SIZE]) {
+    compute_build_id(image, scheduler, digest);
+    for (const auto& obj : objects) {
+        if (obj.filename == "<build-id>") {
+            memcpy(&image[segments.file_offset(obj.data_base_addr)], digest, BUILD_ID_SIZE);
+        }
+    }
+}
+
+// --output-fd: a regular file or memfd is rewritten from offset 0 and cut to
+// the image size, so a reused descriptor never keeps the tail of a longer
+// image. Anything else (a pipe, a socket) gets the bytes as a stream.
+bool write_to_fd(int fd, const std::vector<uint8_t>& bytes) {
+    struct stat st;
+    if (fstat(fd, &st) != 0) return false;
+    const bool regular = S_ISREG(st.st_mode);
+
+    size_t done = 0;
+    while (done < bytes.size()) {
+        ssize_t written = regular ? pwrite(fd, bytes.data() + done, bytes.size() - done,
+                                           static_cast<off_t>(done))
+                                  : write(fd, bytes.data() + done, bytes.size() - done);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        done += static_cast<size_t>(written);
+    }
+    return !regular || ftruncate(fd, static_cast<off_t>(bytes.size())) == 0;
+}
+
+bool write_output(const LinkOptions& options,
                   const std::vector<LoadedObject>& objects,
-                  uint32_t total_text_size,
-                  uint32_t total_data_size) {
-    std::ofstream outfile(output_path, std::ios::binary);
-    if (!outfile) {
-        std::cerr << "Error: Could not open output file " << output_path << std::endl;
+                  const MemoryLayout& layout,
+                  const ImageSegments& segments,
+                  const OutputSizes& sizes,
+                  TaskScheduler& scheduler,
+                  std::vector<uint8_t>& image,
+                  std::vector<uint8_t>& compressed,
+                  std::ostream& log) {
+    const std::string& output_path = options.output_path;
+    const bool compress = options.compress;
+    const uint32_t image_base = segments.base;
+
+    uint8_t build_id[BUILD_ID_SIZE] = {};
+    if (options.build_id) {
+        stamp_build_id(objects, segments, scheduler, image, build_id);
+    }
+
+    // With --compress the image file is wrapped in the block-indexed container;
+    // the raw size is still reported so the two modes can be compared.
+    if (compress) {
+        encode_compressed_image(image, image_base, DEFAULT_IMAGE_BLOCK_SIZE, scheduler, compressed);
+    }
+    const std::vector<uint8_t>& file_bytes = compress ? compressed : image;
+
+    if (options.output_fd >= 0) {
+        if (!write_to_fd(options.output_fd, file_bytes)) {
+            std::cerr << "Error: Failed writing output to descriptor " << options.output_fd << ": "
+                      << strerror(errno) << std::endl;
+            return false;
+        }
+    } else {
+        std::ofstream outfile(output_path, std::ios::binary);
+        if (!outfile) {
+            std::cerr << "Error: Could not open output file " << output_path << std::endl;
+            return false;
+        }
+        outfile.write(reinterpret_cast<const char*>(file_bytes.data()), file_bytes.size());
+        if (!outfile) {
+            std::cerr << "Error: Failed writing output file " << output_path << std::endl;
+            return false;
+        }
+    }
+
+    // Built aside and written once: links in other threads share std::cout,
+    // and its hex/dec state must not be toggled under them
+    std::ostringstream report;
+    report << "Successfully created " << output_path;
+    if (options.output_fd >= 0) report << " (descriptor " << options.output_fd << ")";
+    report << "\n";
+    report << "Text Size: " << sizes.text << " bytes\n";
+    report << "Data Size: " << sizes.data << " bytes\n";
+    if (options.build_id) {
+        report << "Build ID: " << build_id_hex(build_id) << "\n";
+    }
+    if (compress) {
+        report << "Compressed Image: " << compressed.size() << " / " << image.size() << " bytes in "
+               << (image.size() + DEFAULT_IMAGE_BLOCK_SIZE - 1) / DEFAULT_IMAGE_BLOCK_SIZE
+               << " blocks\n";
+    }
+    if (sizes.bss > 0) {
+        report << "BSS Size: " << sizes.bss << " bytes at 0x" << std::hex << sizes.bss_start
+               << std::dec << "\n";
+    }
+    if (sizes.sdata > 0) {
+        report << "Small Data Size: " << sizes.sdata << " bytes at 0x" << std::hex
+               << sizes.sdata_start << std::dec << "\n";
+    }
+    if (layout.regions.size() > 1 || image_base != 0) {
+        report << "Image Base: 0x" << std::hex << image_base << std::dec << "\n";
+        for (const auto& region : layout.regions) {
+            report << "Region " << region.name << ": " << region.used << " / " << region.length
+                   << " bytes\n";
+        }
+    }
+    if (segments.segmented) {
+        for (const auto& entry : segments.entries) {
+            report << "Segment 0x" << std::hex << entry.address << std::dec << ": " << entry.size
+                   << " bytes\n";
+        }
+    }
+    log << report.str() << std::flush;
+    return true;
+}
+
+// --wrap=sym: references to `sym` become references to `__wrap_sym`, and
+// references to `__real_sym` become references to `sym`. As with GNU ld, only
+// references that are undefined in the referring object are redirected, so
+// calls a file makes to its own definition of `sym` stay direct.
+bool build_wrap_renames(const std::vector<std::string>& wrap_symbols,
+                        std::map<std::string, std::string>& renames) {
+    for (const auto& name : wrap_symbols) {
+        std::string wrapped = WRAP_PREFIX + name;
+        if (wrapped.size() >= sizeof(RelocEntry::symbol_name)) {
+            std::cerr << "Error: --wrap=" << name << ": '" << wrapped
+                      << "' exceeds the symbol name limit" << std::endl;
+            return false;
+        }
+        renames[name] = wrapped;
+        renames[REAL_PREFIX + name] = name;
+    }
+    return true;
+}
+
+void wrap_object_references(LoadedObject& obj, const std::map<std::string, std::string>& renames) {
+    std::set<std::string> defined_here;
+    for (const auto& sym : obj.symbols) {
+        if (sym.type != SYMBOL_UNDEFINED) {
+            defined_here.insert(sym.name);
+        }
+    }
+
+    for (auto& reloc : obj.relocs) {
+        auto rename = renames.find(reloc.symbol_name);
+        if (rename == renames.end() || defined_here.count(rename->first)) continue;
+
+        memset(reloc.symbol_name, 0, sizeof(reloc.symbol_name));
+        memcpy(reloc.symbol_name, rename->second.c_str(), rename->second.size());
+    }
+}
+
+// Creates the data-only object that will hold the --export-table hash table.
+// Its contents are filled in by fill_export_table once addresses are final.
+bool build_export_table_object(const std::string& list_path,
+                               ExportTable& table,
+                               std::vector<std::string>& roots,
+                               LoadedObject& obj) {
+    std::vector<std::string> names;
+    if (!read_export_list(list_path, names) || !build_export_table(names, table)) {
         return false;
     }
 
-    // Write all Text sections
-    for (const auto& obj : objects) {
-        if (!obj.text_section.empty()) {
-            outfile.write(reinterpret_cast<const char*>(obj.text_section.data()),
-                          obj.text_section.size());
+    obj = LoadedObject();
+    obj.filename = "<export-table>";
+    obj.header = FileHeader();
+    obj.header.data_size = table.encoded_size;
+    obj.header.data_align = 4;
+    obj.data_section.assign(table.encoded_size, 0);
+
+    SymbolEntry sym = SymbolEntry();
+    strncpy(sym.name, EXPORT_TABLE_SYMBOL, sizeof(sym.name) - 1);
+    sym.type = SYMBOL_DEFINED;
+    sym.section = SECTION_DATA;
+    sym.size = table.encoded_size;
+    obj.symbols.push_back(sym);
+    obj.header.symtable_count = 1;
+
+    // Every exported name must be linked in, plus the table itself
+    roots.insert(roots.end(), names.begin(), names.end());
+    roots.push_back(EXPORT_TABLE_SYMBOL);
+    return true;
+}
+
+void build_build_id_object(std::vector<std::string>& roots, LoadedObject& obj) {
+    obj = LoadedObject();
+    obj.filename = "<build-id>";
+    obj.header = FileHeader();
+    obj.header.data_size = BUILD_ID_SIZE;
+    obj.header.data_align = 4;
+    obj.data_section.assign(BUILD_ID_SIZE, 0);
+
+    SymbolEntry sym = SymbolEntry();
+    strncpy(sym.name, BUILD_ID_SYMBOL, sizeof(sym.name) - 1);
+    sym.type = SYMBOL_DEFINED;
+    sym.section = SECTION_DATA;
+    sym.size = BUILD_ID_SIZE;
+    obj.symbols.push_back(sym);
+    obj.header.symtable_count = 1;
+
+    roots.push_back(BUILD_ID_SYMBOL);
+}
+
+bool fill_export_table(std::vector<LoadedObject>& objects,
+                       const ExportTable& table,
+                       const SymbolTable& global_symbol_table) {
+    for (auto& obj : objects) {
+        if (obj.filename == "<export-table>") {
+            return encode_export_table(table, obj.data_base_addr, global_symbol_table,
+                                       obj.data_section);
         }
     }
+    return true;
+}
 
-    // Write all Data sections
-    for (const auto& obj : objects) {
-        if (!obj.data_section.empty()) {
-            outfile.write(reinterpret_cast<const char*>(obj.data_section.data()),
-                          obj.data_section.size());
+bool resolve_input_paths(const LinkOptions& options, std::vector<std::string>& input_files) {
+    input_files.clear();
+    input_files.reserve(options.inputs.size());
+
+    for (const auto& input : options.inputs) {
+        if (!input.is_library) {
+            input_files.push_back(input.name);
+            continue;
+        }
+
+        std::string path;
+        if (!find_library(options.library_paths, input.name, path)) {
+            std::cerr << "Error: Cannot find library -l" << input.name << std::endl;
+            return false;
         }
+        input_files.push_back(path);
     }
 
-    std::cout << "Successfully created " << output_path << std::endl;
-    std::cout << "Text Size: " << total_text_size << " bytes" << std::endl;
-    std::cout << "Data Size: " << total_data_size << " bytes" << std::endl;
+    return true;
+}
 
+// Reads the --link-shared symbol files. Two images may neither overlap nor
+// export the same name.
+bool read_shared_images(const std::vector<std::string>& paths, std::vector<SharedImage>& images) {
+    std::map<std::string, const SharedImage*> exporter;
+    for (const auto& path : paths) {
+        SharedImage image;
+        if (!read_shared_image(path, image)) {
+            return false;
+        }
+        for (const auto& other : images) {
+            for (const auto& range : image.ranges) {
+                if (shared_image_overlaps(other, range.first, range.second)) {
+                    std::cerr << "Error: Shared images " << other.symbols_path << " and " << path
+                              << " overlap" << std::endl;
+                    return false;
+                }
+            }
+        }
+        images.push_back(std::move(image));
+    }
+
+    for (const auto& image : images) {
+        for (const auto& symbol : image.symbols) {
+            auto result = exporter.emplace(symbol.first, &image);
+            if (!result.second) {
+                std::cerr << "Error: Symbol '" << symbol.first << "' exported by both "
+                          << result.first->second->symbols_path << " and " << image.symbols_path
+                          << std::endl;
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// A strong definition in a linked object of a name that a shared image
+// exports is a duplicate, as it would be with the library linked statically
+bool check_import_conflicts(const std::vector<LoadedObject>& objects,
+                            const std::vector<bool>& object_active,
+                            const std::vector<SharedImage>& images) {
+    if (images.empty()) return true;
+    for (size_t i = 0; i < objects.size() && i < object_active.size(); ++i) {
+        if (!object_active[i]) continue;
+        for (const auto& sym : objects[i].symbols) {
+            if (sym.type != SYMBOL_DEFINED || is_linker_owned_symbol(sym.name)) continue;
+            for (const auto& image : images) {
+                if (image.symbols.count(sym.name)) {
+                    std::cerr << "Error: Duplicate symbol definition '" << sym.name << "' ("
+                              << objects[i].filename << " and shared image "
+                              << image.symbols_path << ")" << std::endl;
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+// The program may not be placed over memory a shared image occupies
+bool check_shared_overlap(const MemoryLayout& layout, const std::vector<SharedImage>& images) {
+    for (const auto& region : layout.regions) {
+        if (region.used == 0) continue;
+        for (const auto& image : images) {
+            if (shared_image_overlaps(image, region.origin, region.origin + region.used)) {
+                std::cerr << "Error: Region '" << region.name << "' overlaps shared image "
+                          << image.symbols_path << " (" << image.image_path << ")" << std::endl;
+                return false;
+            }
+        }
+    }
     return true;
 }
 
+// Describes the image just written for programs that link against it.
+// Linker-defined section bounds and symbols imported from other shared
+// images are not exported.
+bool write_shared_symbols(const LinkOptions& options,
+                          const MemoryLayout& layout,
+                          const ImageSegments& segments,
+                          const OutputSizes& sizes,
+                          const std::vector<uint8_t>& image,
+                          const SymbolResolver& resolver,
+                          const SymbolTable& global_symbol_table) {
+    SharedImage shared;
+    shared.image_path = options.output_path;
+    shared.image_base = segments.base;
+    shared.image_size = static_cast<uint32_t>(image.size());
+    shared.bss_start = sizes.bss_start;
+    shared.bss_end = sizes.bss_end;
+    for (const auto& region : layout.regions) {
+        if (region.used > 0) shared.ranges.emplace_back(region.origin, region.origin + region.used);
+    }
+    for (const auto& shard : global_symbol_table.shards()) {
+        for (const auto& symbol : shard) {
+            const std::string& name = symbol.first;
+            if (is_linker_owned_symbol(name) || resolver.imports().count(name)) {
+                continue;
+            }
+            shared.symbols.insert(symbol);
+        }
+    }
+    return write_shared_image(options.shared_symbols_path, shared);
+}
+
+bool same_object_contents(const LoadedObject& a, const LoadedObject& b) {
+    return memcmp(&a.header, &b.header, sizeof(FileHeader)) == 0 &&
+           a.text_section == b.text_section && a.data_section == b.data_section &&
+           a.sdata_section == b.sdata_section && a.symbols.size() == b.symbols.size() &&
+           a.relocs.size() == b.relocs.size() &&
+           memcmp(a.symbols.data(), b.symbols.data(), a.symbols.size() * sizeof(SymbolEntry)) == 0 &&
+           memcmp(a.relocs.data(), b.relocs.data(), a.relocs.size() * sizeof(RelocEntry)) == 0;
+}
+
+// Drops objects[index] if an earlier object has the same contents: a link
+// line that names one object twice (or two identical builds of it) links a
+// single copy instead of failing on duplicate symbols. The hash only picks
+// candidates; the parsed contents decide.
+bool fold_identical_object(std::vector<LoadedObject>& objects, size_t index,
+                           std::unordered_multimap<uint64_t, size_t>& objects_by_hash) {
+    uint64_t hash = objects[index].content_hash;
+    auto range = objects_by_hash.equal_range(hash);
+    for (auto it = range.first; it != range.second; ++it) {
+        if (same_object_contents(objects[it->second], objects[index])) {
+            objects[index] = LoadedObject();
+            return true;
+        }
+    }
+    objects_by_hash.emplace(hash, index);
+    return false;
+}
+
+// One entry per active object, in the order layout keeps them
+std::vector<ObjectReason> activation_reasons(const std::vector<LoadedObject>& objects,
+                                             const SymbolResolver& resolver) {
+    const std::vector<bool>& active = resolver.active();
+    const std::vector<Activation>& activations = resolver.activations();
+
+    std::vector<ObjectReason> reasons;
+    for (size_t i = 0; i < objects.size(); ++i) {
+        if (i >= active.size() || !active[i]) continue;
+        ObjectReason reason;
+        reason.symbol = activations[i].symbol;
+        if (activations[i].needed_by != NO_OBJECT) {
+            reason.needed_by = objects[activations[i].needed_by].filename;
+        }
+        reasons.push_back(reason);
+    }
+    return reasons;
+}
+
 }  // namespace
 
-bool link_objects(const std::vector<std::string>& input_files, const std::string& output_path) {
-    std::vector<LoadedObject> objects;
-    objects.reserve(input_files.size());
+bool link_objects(const LinkOptions& options, LinkContext& context) {
+    context.reset(!options.size_report_path.empty());
 
-    // Pass 0: Load all files
-    for (const auto& path : input_files) {
-        LoadedObject obj;
-        if (!load_object_file(path, obj)) {
+    // Resolve -l names before anything is read
+    std::vector<std::string> input_files;
+    if (!resolve_input_paths(options, input_files)) {
+        return false;
+    }
+    // --wrap redirection happens per object as it loads, before resolution
+    // sees it, so wrappers get pulled in
+    std::map<std::string, std::string> wrap_renames;
+    if (!build_wrap_renames(options.wrap_symbols, wrap_renames)) {
+        return false;
+    }
+
+    // Linker-generated objects: the name -> address table and the build ID
+    // slot. Built up front so their roots are known when resolution starts.
+    ExportTable export_table;
+    std::vector<std::string> extra_roots;
+    std::vector<LoadedObject> generated;
+    if (!options.export_table_path.empty()) {
+        LoadedObject table_object;
+        if (!build_export_table_object(options.export_table_path, export_table, extra_roots,
+                                       table_object)) {
             return false;
         }
+        generated.push_back(std::move(table_object));
+    }
+    if (options.build_id) {
+        LoadedObject id_object;
+        build_build_id_object(extra_roots, id_object);
+        generated.push_back(std::move(id_object));
+    }
+
+    std::vector<SharedImage> shared_images;
+    if (!read_shared_images(options.link_shared, shared_images)) {
+        return false;
+    }
+
+    // A shared image has no entry point: every input is linked and exported
+    SymbolResolver& resolver = context.resolver;
+    if (options.shared_symbols_path.empty()) {
+        resolver.add_root("__START__");
+    } else {
+        resolver.link_every_object();
+    }
+    // Images written before linker-owned names were left out may still list
+    // them; this link's own __build_id or __export_table wins over those
+    for (const auto& image : shared_images) {
+        for (const auto& symbol : image.symbols) {
+            if (!is_linker_owned_symbol(symbol.first)) {
+                resolver.add_import(symbol.first, symbol.second);
+            }
+        }
+    }
+    for (const auto& root : extra_roots) {
+        resolver.add_root(root);
+    }
+
+    TaskScheduler& scheduler = context.scheduler(options.threads);
+
+    // Informational messages; with --output-fd=1 stdout carries the image
+    std::ostream& log = options.output_fd == STDOUT_FILENO ? std::cerr : std::cout;
+
+    std::unique_ptr<LinkStats> stats;
+    if (!options.stats_path.empty()) {
+        stats.reset(new LinkStats(options.perf_counters, scheduler.thread_ids()));
+        stats->begin_phase("load");
+    }
+
+    // Archives (*.lib) stay on the main thread: only their index is read
+    // here, at their place on the link line. Everything else is an object.
+    // A path that was already listed is dropped before anything is read;
+    // the same contents under another path are folded after loading.
+    enum InputKind : uint8_t { INPUT_OBJECT, INPUT_ARCHIVE, INPUT_REPEAT };
+    std::vector<InputKind> input_kind(input_files.size());
+    std::vector<std::string> object_files;
+    std::set<std::string> seen_paths;
+    for (size_t i = 0; i < input_files.size(); ++i) {
+        std::string normal = std::filesystem::path(input_files[i]).lexically_normal().string();
+        if (!seen_paths.insert(normal).second) {
+            input_kind[i] = INPUT_REPEAT;
+        } else if (is_archive_path(input_files[i])) {
+            input_kind[i] = INPUT_ARCHIVE;
+        } else {
+            input_kind[i] = INPUT_OBJECT;
+            object_files.push_back(input_files[i]);
+        }
+    }
+
+    // Pass 0: Load all objects in parallel while this thread resolves symbols
+    // from the objects that are already in, strictly in link-line order.
+    // Slots are preallocated so loads never reallocate under the resolver.
+    enum : uint8_t { LOAD_PENDING, LOAD_OK, LOAD_FAILED };
+    std::vector<LoadedObject>& objects = context.objects;
+    std::vector<std::string>& load_errors = context.load_errors;
+    while (objects.size() < object_files.size()) {
+        objects.push_back(context.recycled_object());
+    }
+    load_errors.resize(object_files.size());
+    std::unique_ptr<std::atomic<uint8_t>[]> load_state(new std::atomic<uint8_t>[object_files.size()]);
+    for (size_t i = 0; i < object_files.size(); ++i) {
+        load_state[i].store(LOAD_PENDING, std::memory_order_relaxed);
+    }
+
+    // Fetched archive members and generated objects follow the link-line
+    // objects, in the order they are added. A deque keeps them in place for
+    // the resolver; they join `objects` once resolution is done.
+    std::vector<std::unique_ptr<Archive>> archives;
+    std::vector<std::pair<const Archive*, uint32_t>> members;
+    std::deque<LoadedObject> extra_objects;
+    resolver.set_member_fetcher([&](uint32_t member, const LoadedObject*& obj, size_t& index) {
+        extra_objects.push_back(context.recycled_object());
+        LoadedObject& loaded = extra_objects.back();
+        if (!members[member].first->load_member(members[member].second, loaded)) {
+            return false;
+        }
+        wrap_object_references(loaded, wrap_renames);
+        obj = &loaded;
+        index = objects.size() + extra_objects.size() - 1;
+        return true;
+    });
+
+    TaskGroup loads(scheduler);
+    loads.run([&]() {
+        load_object_files(object_files, objects, load_errors, scheduler, options.io_uring,
+                          [&](size_t i, bool ok) {
+                              if (ok) wrap_object_references(objects[i], wrap_renames);
+                              load_state[i].store(ok ? LOAD_OK : LOAD_FAILED,
+                                                  std::memory_order_release);
+                          },
+                          options.io_uring ? context.uring_reader() : nullptr);
+    });
+
+    // Objects whose contents match an earlier object are never given to the
+    // resolver, so they are neither laid out nor reported as duplicates
+    std::unordered_multimap<uint64_t, size_t> objects_by_hash;
+    size_t folded_inputs = 0;
+
+    bool load_ok = true;
+    size_t next_object = 0;
+    for (size_t pos = 0; pos < input_files.size() && load_ok; ++pos) {
+        if (input_kind[pos] == INPUT_REPEAT) {
+            ++folded_inputs;
+        } else if (input_kind[pos] == INPUT_ARCHIVE) {
+            archives.emplace_back(new Archive());
+            if (!archives.back()->open(input_files[pos])) {
+                load_ok = false;
+                break;
+            }
+            uint32_t first_member = static_cast<uint32_t>(members.size());
+            for (uint32_t m = 0; m < archives.back()->member_count(); ++m) {
+                members.emplace_back(archives.back().get(), m);
+            }
+            for (const auto& symbol : archives.back()->symbols()) {
+                resolver.add_lazy_symbol(symbol.name, first_member + symbol.member);
+            }
+        } else {
+            size_t i = next_object++;
+            uint8_t state;
+            while ((state = load_state[i].load(std::memory_order_acquire)) == LOAD_PENDING) {
+                if (!scheduler.run_one()) std::this_thread::yield();
+            }
+            if (state == LOAD_FAILED) {
+                std::cerr << load_errors[i];
+                load_ok = false;
+                break;
+            }
+            if (fold_identical_object(objects, i, objects_by_hash)) {
+                ++folded_inputs;
+            } else {
+                resolver.add_object(objects[i], i);
+            }
+        }
+        if (resolver.failed()) load_ok = false;
+    }
+    loads.wait();
+    if (!load_ok) {
+        return false;
+    }
+
+    for (auto& obj : generated) {
+        extra_objects.push_back(std::move(obj));
+        resolver.add_object(extra_objects.back(), objects.size() + extra_objects.size() - 1);
+    }
+    resolver.finish();
+    if (resolver.failed()) {
+        return false;
+    }
+    for (auto& obj : extra_objects) {
         objects.push_back(std::move(obj));
     }
+    extra_objects.clear();
+    archives.clear();
+
+    // Activation reasons by name, taken before layout drops unused objects
+    std::vector<ObjectReason> reasons;
+    if (!options.size_report_path.empty()) {
+        reasons = activation_reasons(objects, resolver);
+    }
 
     // Pass 1: Layout & Symbol Definition
-    std::map<std::string, uint32_t> global_symbol_table;
-    uint32_t total_text_size = 0;
-    uint32_t total_data_size = 0;
-    if (!layout_and_define_symbols(objects, global_symbol_table, total_text_size, total_data_size)) {
+    if (stats) stats->begin_phase("layout");
+    MemoryLayout layout = default_memory_layout();
+    if (!options.memory_layout_path.empty() &&
+        !parse_memory_layout_file(options.memory_layout_path, layout)) {
+        return false;
+    }
+
+    if (!check_import_conflicts(objects, resolver.active(), shared_images)) {
+        return false;
+    }
+    drop_inactive_objects(objects, resolver.active(), context);
+    SymbolTable& global_symbol_table = context.symbol_table;
+    OutputSizes sizes;
+    if (!layout_and_define_symbols(objects, layout, options.align_functions, resolver, scheduler,
+                                   global_symbol_table, sizes)) {
+        return false;
+    }
+    const std::set<std::string>& needed_symbols = resolver.needed();
+
+    // Pass 1b: Relaxation on the final layout
+    if (stats && options.relax) stats->begin_phase("relax");
+    if (options.relax &&
+        !relax_branches(objects, layout, options.align_functions, needed_symbols,
+                        resolver.imports(), scheduler, global_symbol_table, sizes, log)) {
         return false;
     }
 
-    // Pass 2: Relocation & Patching
-    if (!apply_relocations(objects, global_symbol_table)) {
+    if (!check_shared_overlap(layout, shared_images)) {
+        return false;
+    }
+
+    if (!options.export_table_path.empty() &&
+        !fill_export_table(objects, export_table, global_symbol_table)) {
+        return false;
+    }
+
+    // Pass 2: Relocation & Patching, overlapped with building the image
+    if (stats) stats->begin_phase("relocate");
+    std::vector<uint8_t>& image = context.image;
+    const ImageSegments segments = plan_image(objects, layout);
+    if (!relocate_into_image(objects, global_symbol_table, segments, options.text_fill, scheduler,
+                             image)) {
         return false;
     }
 
     // Pass 3: Write Output
-    return write_output(output_path, objects, total_text_size, total_data_size);
+    if (stats) stats->begin_phase("output");
+    if (!write_output(options, objects, layout, segments, sizes, scheduler, image,
+                      context.compressed_image, log)) {
+        return false;
+    }
+    if (!options.shared_symbols_path.empty() &&
+        !write_shared_symbols(options, layout, segments, sizes, image, resolver,
+                              global_symbol_table)) {
+        return false;
+    }
+    if (!options.size_report_path.empty()) {
+        // Objects the linker added during layout (<common>) have no reason
+        reasons.resize(objects.size());
+        for (size_t i = 0; i < reasons.size(); ++i) {
+            if (reasons[i].symbol.empty()) reasons[i].generated = true;
+        }
+        if (!write_size_report(options.size_report_path, objects, reasons, global_symbol_table)) {
+            return false;
+        }
+    }
+
+    if (stats) {
+        stats->end_phase();
+        stats->set("threads", scheduler.thread_count());
+        stats->set("inputs", input_files.size());
+        stats->set("folded_inputs", folded_inputs);
+        stats->set("linked_objects",
+                   std::count(resolver.active().begin(), resolver.active().end(), true));
+        stats->set("image_bytes", image.size());
+        return stats->write_json(options.stats_path);
+    }
+    return true;
+}
+
+bool link_objects(const LinkOptions& options) {
+    LinkContext context;
+    return link_objects(options, context);
+}
+
+bool link_objects(const std::vector<std::string>& input_files, const std::string& output_path) {
+    LinkOptions options;
+    options.output_path = output_path;
+    for (const auto& path : input_files) {
+        options.inputs.push_back({path, false});
+    }
+    return link_objects(options);
 }
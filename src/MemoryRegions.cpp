@@ -0,0 +1,217 @@
+#include "MemoryRegions.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#include "ObjectFormat.h"
+
+namespace {
+
+bool parse_number(const std::string& text, uint64_t& value) {
+    if (text.empty()) return false;
+    try {
+        size_t consumed = 0;
+        value = std::stoull(text, &consumed, 0);  // Accepts 0x.. and decimal
+        if (consumed == text.size()) return true;
+
+        // Allow K / M suffixes for sizes
+        if (consumed + 1 == text.size()) {
+            char suffix = text.back();
+            if (suffix == 'K' || suffix == 'k') { value <<= 10; return true; }
+            if (suffix == 'M' || suffix == 'm') { value <<= 20; return true; }
+        }
+    } catch (const std::exception&) {
+    }
+    return false;
+}
+
+bool section_from_name(const std::string& name, uint32_t& section) {
+    if (name == ".text") { section = SECTION_TEXT; return true; }
+    if (name == ".data") { section = SECTION_DATA; return true; }
+    if (name == ".sdata") { section = SECTION_SDATA; return true; }
+    if (name == ".bss") { section = SECTION_BSS; return true; }
+    return false;
+}
+
+// "r", "rx", "rw", "rwx", ... in any order, each letter at most once
+bool parse_access(const std::string& attr, uint32_t& access) {
+    access = 0;
+    for (char c : attr) {
+        uint32_t bit = 0;
+        if (c == 'r') bit = REGION_READ;
+        if (c == 'w') bit = REGION_WRITE;
+        if (c == 'x') bit = REGION_EXEC;
+        if (bit == 0 || (access & bit)) return false;
+        access |= bit;
+    }
+    return access != 0;
+}
+
+}  // namespace
+
+bool MemoryRegion::allows_section(uint32_t section) const {
+    if (access == 0) return true;
+    return section == SECTION_TEXT ? (access & REGION_EXEC) != 0 : (access & REGION_WRITE) != 0;
+}
+
+uint32_t MemoryLayout::image_base() const {
+    uint32_t base = UINT32_MAX;
+    for (const auto& region : regions) {
+        base = std::min(base, region.origin);
+    }
+    return regions.empty() ? 0 : base;
+}
+
+MemoryLayout default_memory_layout() {
+    MemoryLayout layout;
+    MemoryRegion ram;
+    ram.name = "ram";
+    ram.origin = 0;
+    ram.length = 0x100000000ULL;
+    layout.regions.push_back(ram);
+    return layout;
+}
+
+bool parse_memory_layout_file(const std::string& path, MemoryLayout& layout) {
+    std::ifstream file(path);
+    if (!file) {
+        std::cerr << "Error: Could not open memory layout file " << path << std::endl;
+        return false;
+    }
+
+    layout = MemoryLayout();
+
+    // Placement rules may name regions declared later in the file
+    struct PendingPlace {
+        std::string target;
+        std::string region;
+        int line;
+    };
+    std::vector<PendingPlace> places;
+
+    std::string line;
+    int line_no = 0;
+    while (std::getline(file, line)) {
+        ++line_no;
+        size_t comment = line.find('#');
+        if (comment != std::string::npos) {
+            line.erase(comment);
+        }
+
+        std::istringstream iss(line);
+        std::string keyword;
+        if (!(iss >> keyword)) continue;
+
+        if (keyword == "region") {
+            MemoryRegion region;
+            std::string origin_text, length_text;
+            if (!(iss >> region.name >> origin_text >> length_text)) {
+                std::cerr << "Error: " << path << ":" << line_no
+                          << ": expected 'region <name> <origin> <length> [attributes...]'" << std::endl;
+                return false;
+            }
+
+            uint64_t origin = 0;
+            if (!parse_number(origin_text, origin) || origin > UINT32_MAX ||
+                !parse_number(length_text, region.length)) {
+                std::cerr << "Error: " << path << ":" << line_no << ": bad number in region '"
+                          << region.name << "'" << std::endl;
+                return false;
+            }
+            region.origin = static_cast<uint32_t>(origin);
+            if (origin + region.length > 0x100000000ULL) {
+                std::cerr << "Error: " << path << ":" << line_no << ": region '" << region.name
+                          << "' extends past the 32-bit address space" << std::endl;
+                return false;
+            }
+
+            for (const auto& other : layout.regions) {
+                if (other.name == region.name) {
+                    std::cerr << "Error: " << path << ":" << line_no << ": duplicate region '"
+                              << region.name << "'" << std::endl;
+                    return false;
+                }
+                uint64_t lo = std::max<uint64_t>(other.origin, region.origin);
+                uint64_t hi = std::min(other.origin + other.length, region.origin + region.length);
+                if (lo < hi) {
+                    std::cerr << "Error: " << path << ":" << line_no << ": region '" << region.name
+                              << "' overlaps region '" << other.name << "'" << std::endl;
+                    return false;
+                }
+            }
+
+            std::string attr;
+            while (iss >> attr) {
+                if (attr == "fast") {
+                    region.fast = true;
+                    continue;
+                }
+                uint32_t access = 0;
+                if (!parse_access(attr, access)) continue;  // A label
+                if (region.access != 0) {
+                    std::cerr << "Error: " << path << ":" << line_no << ": region '" << region.name
+                              << "' has more than one access attribute" << std::endl;
+                    return false;
+                }
+                region.access = access;
+            }
+            layout.regions.push_back(region);
+        } else if (keyword == "place") {
+            PendingPlace place;
+            place.line = line_no;
+            std::string extra;
+            if (!(iss >> place.target) || (iss >> place.region && iss >> extra)) {
+                std::cerr << "Error: " << path << ":" << line_no
+                          << ": expected 'place <.section|symbol> [region]'" << std::endl;
+                return false;
+            }
+            places.push_back(place);
+        } else {
+            std::cerr << "Error: " << path << ":" << line_no << ": unknown keyword '" << keyword
+                      << "'" << std::endl;
+            return false;
+        }
+    }
+
+    if (layout.regions.empty()) {
+        std::cerr << "Error: " << path << ": no regions defined" << std::endl;
+        return false;
+    }
+
+    for (const auto& place : places) {
+        size_t region_index = layout.regions.size();
+        for (size_t r = 0; r < layout.regions.size(); ++r) {
+            if (place.region.empty() ? layout.regions[r].fast
+                                     : layout.regions[r].name == place.region) {
+                region_index = r;
+                break;
+            }
+        }
+        if (region_index == layout.regions.size() && place.region.empty()) {
+            std::cerr << "Error: " << path << ":" << place.line << ": 'place " << place.target
+                      << "' names no region and no region is marked fast" << std::endl;
+            return false;
+        }
+        if (region_index == layout.regions.size()) {
+            std::cerr << "Error: " << path << ":" << place.line << ": unknown region '"
+                      << place.region << "'" << std::endl;
+            return false;
+        }
+
+        uint32_t section = 0;
+        if (place.target[0] == '.') {
+            if (!section_from_name(place.target, section)) {
+                std::cerr << "Error: " << path << ":" << place.line << ": unknown section '"
+                          << place.target << "'" << std::endl;
+                return false;
+            }
+            layout.section_region[section] = region_index;
+        } else {
+            layout.symbol_region[place.target] = region_index;
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,393 @@
+#include "ObjectDump.h"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+
+#include "JsonOutput.h"
+#include "Linker.h"
+#include "ObjectLoader.h"
+#include "TaskScheduler.h"
+
+namespace {
+
+struct ObjectCounts {
+    uint64_t text = 0, data = 0, sdata = 0, bss = 0;
+    uint64_t symbols = 0, undefined = 0, relocs = 0;
+
+    void add(const ObjectCounts& other) {
+        text += other.text;
+        data += other.data;
+        sdata += other.sdata;
+        bss += other.bss;
+        symbols += other.symbols;
+        undefined += other.undefined;
+        relocs += other.relocs;
+    }
+};
+
+// What is kept of an object once it has been formatted
+struct DumpedObject {
+    std::string text;                  // Formatted output for this object
+    std::string error;                 // Loader message, empty on success
+    ObjectCounts counts;
+    std::vector<std::string> defined;  // Strong definitions, for --duplicates
+};
+
+const char* section_name(uint32_t section) {
+    switch (section) {
+        case SECTION_TEXT: return "TEXT";
+        case SECTION_DATA: return "DATA";
+        case SECTION_SDATA: return "SDATA";
+        case SECTION_BSS: return "BSS";
+    }
+    return "?";
+}
+
+const char* symbol_type_name(uint32_t type) {
+    switch (type) {
+        case SYMBOL_UNDEFINED: return "UNDEF";
+        case SYMBOL_DEFINED: return "DEF";
+        case SYMBOL_WEAK: return "WEAK";
+        case SYMBOL_COMMON: return "COMM";
+    }
+    return "?";
+}
+
+const char* reloc_type_name(uint32_t type) {
+    switch (type) {
+        case RELOC_ABSOLUTE: return "ABS";
+        case RELOC_RELATIVE: return "REL";
+        case RELOC_HI16: return "HI16";
+        case RELOC_LO16: return "LO16";
+        case RELOC_SDA16: return "SDA16";
+        case RELOC_BRANCH26: return "BR26";
+    }
+    return "?";
+}
+
+// Name fields are fixed 64-byte arrays and need not be NUL-terminated
+template <size_t N>
+std::string field_string(const char (&field)[N]) {
+    return std::string(field, strnlen(field, N));
+}
+
+ObjectCounts count_object(const LoadedObject& obj) {
+    ObjectCounts counts;
+    counts.text = obj.header.text_size;
+    counts.data = obj.header.data_size;
+    counts.sdata = obj.header.sdata_size;
+    counts.bss = obj.header.bss_size;
+    counts.symbols = obj.symbols.size();
+    counts.relocs = obj.relocs.size();
+    for (const auto& sym : obj.symbols) {
+        if (sym.type == SYMBOL_UNDEFINED) ++counts.undefined;
+    }
+    return counts;
+}
+
+std::string hex_string(const std::vector<uint8_t>& bytes) {
+    static const char digits[] = "0123456789abcdef";
+    std::string hex;
+    hex.reserve(bytes.size() * 2);
+    for (uint8_t b : bytes) {
+        hex += digits[b >> 4];
+        hex += digits[b & 0xF];
+    }
+    return hex;
+}
+
+// Same layout as tools/obj_dump.py
+void write_hexdump(std::ostream& out, const char* name, const std::vector<uint8_t>& bytes,
+                   unsigned width) {
+    if (bytes.empty()) return;
+    out << "\n" << name << " (" << bytes.size() << " bytes)\n" << std::hex << std::setfill('0');
+    for (size_t line = 0; line < bytes.size(); line += width) {
+        size_t count = std::min<size_t>(width, bytes.size() - line);
+        out << "  " << std::setw(8) << line << ": ";
+        for (size_t k = 0; k < width; ++k) {
+            if (k < count) {
+                out << std::setw(2) << unsigned(bytes[line + k]) << ' ';
+            } else {
+                out << "   ";
+            }
+        }
+        out << " |";
+        for (size_t k = 0; k < count; ++k) {
+            uint8_t c = bytes[line + k];
+            out << (c >= 32 && c < 127 ? static_cast<char>(c) : '.');
+        }
+        out << "|\n";
+    }
+    out << std::dec << std::setfill(' ');
+}
+
+void format_text(std::ostream& out, const std::string& path, const LoadedObject& obj,
+                 unsigned width) {
+    const FileHeader& h = obj.header;
+    out << "== " << path << " ==\n";
+    out << "Header: text=" << h.text_size << " bytes, data=" << h.data_size
+        << " bytes, symbols=" << h.symtable_count << ", relocs=" << h.reloc_count << "\n";
+    if (h.magic == LINKER_MAGIC_V2) {
+        out << "        LNK2: flags=0x" << std::hex << h.flags << std::dec;
+        if (h.flags & OBJ_FLAG_RELAXABLE) out << " (relaxable)";
+        if (h.flags & OBJ_FLAG_COMPRESSED) out << " (compressed)";
+        if (h.flags & OBJ_FLAG_CHECKSUMS) out << " (checksums verified)";
+        out << ", text_align=" << h.text_align << ", data_align=" << h.data_align
+            << ", sdata=" << h.sdata_size << " bytes (align " << h.sdata_align
+            << "), bss=" << h.bss_size << " bytes (align " << h.bss_align << ")\n";
+    }
+
+    write_hexdump(out, ".text", obj.text_section, width);
+    write_hexdump(out, ".data", obj.data_section, width);
+    write_hexdump(out, ".sdata", obj.sdata_section, width);
+
+    if (!obj.symbols.empty()) {
+        out << "\nSymbols:\n";
+        for (size_t i = 0; i < obj.symbols.size(); ++i) {
+            const SymbolEntry& sym = obj.symbols[i];
+            out << "  [" << std::setw(2) << std::setfill('0') << i << std::setfill(' ') << "] "
+                << std::left << std::setw(20) << field_string(sym.name)
+                << " type=" << std::setw(5) << symbol_type_name(sym.type)
+                << " section=" << std::setw(5) << section_name(sym.section) << std::right
+                << " offset=0x" << std::hex << sym.offset << std::dec;
+            if (sym.align > 1) out << " align=" << sym.align;
+            if (sym.size) out << " size=" << sym.size;
+            out << "\n";
+        }
+    }
+
+    if (!obj.relocs.empty()) {
+        out << "\nRelocations:\n";
+        for (size_t i = 0; i < obj.relocs.size(); ++i) {
+            const RelocEntry& reloc = obj.relocs[i];
+            out << "  [" << std::setw(2) << std::setfill('0') << i << std::setfill(' ')
+                << "] offset=0x" << std::hex << reloc.offset << std::dec
+                << " type=" << std::left << std::setw(5) << reloc_type_name(reloc.type)
+                << std::right << " symbol=" << field_string(reloc.symbol_name) << "\n";
+        }
+    }
+    out << "\n";
+}
+
+void format_summary_text(std::ostream& out, const std::string& label, const ObjectCounts& c) {
+    out << std::setw(9) << c.text << std::setw(9) << c.data << std::setw(9) << c.sdata
+        << std::setw(9) << c.bss << std::setw(9) << c.symbols << std::setw(7) << c.undefined
+        << std::setw(8) << c.relocs << "  " << label << "\n";
+}
+
+void write_json_counts(std::ostream& out, const ObjectCounts& c) {
+    out << "\"text_size\": " << c.text << ", \"data_size\": " << c.data
+        << ", \"sdata_size\": " << c.sdata << ", \"bss_size\": " << c.bss
+        << ", \"symbol_count\": " << c.symbols << ", \"undefined_count\": " << c.undefined
+        << ", \"reloc_count\": " << c.relocs;
+}
+
+void format_json(std::ostream& out, const std::string& path, const LoadedObject& obj,
+                 const ObjectCounts& counts, bool summary) {
+    const FileHeader& h = obj.header;
+    out << "    {\"file\": ";
+    write_json_string(out, path);
+    out << ", \"format\": \"" << (h.magic == LINKER_MAGIC_V2 ? "LNK2" : "LNK1") << "\""
+        << ", \"flags\": " << h.flags << ", ";
+    write_json_counts(out, counts);
+    out << ", \"text_align\": " << h.text_align << ", \"data_align\": " << h.data_align
+        << ", \"sdata_align\": " << h.sdata_align << ", \"bss_align\": " << h.bss_align;
+
+    if (!summary) {
+        out << ",\n     \"text\": \"" << hex_string(obj.text_section) << "\""
+            << ",\n     \"data\": \"" << hex_string(obj.data_section) << "\""
+            << ",\n     \"sdata\": \"" << hex_string(obj.sdata_section) << "\"";
+
+        out << ",\n     \"symbols\": [";
+        for (size_t i = 0; i < obj.symbols.size(); ++i) {
+            const SymbolEntry& sym = obj.symbols[i];
+            out << (i ? ",\n       " : "\n       ") << "{\"name\": ";
+            write_json_string(out, field_string(sym.name));
+            out << ", \"type\": \"" << symbol_type_name(sym.type) << "\", \"section\": \""
+                << section_name(sym.section) << "\", \"offset\": " << sym.offset
+                << ", \"align\": " << sym.align << ", \"size\": " << sym.size << "}";
+        }
+        out << "]";
+
+        out << ",\n     \"relocs\": [";
+        for (size_t i = 0; i < obj.relocs.size(); ++i) {
+            const RelocEntry& reloc = obj.relocs[i];
+            out << (i ? ",\n       " : "\n       ") << "{\"offset\": " << reloc.offset
+                << ", \"type\": \"" << reloc_type_name(reloc.type) << "\", \"symbol\": ";
+            write_json_string(out, field_string(reloc.symbol_name));
+            out << "}";
+        }
+        out << "]";
+    }
+    out << "}";
+}
+
+// Expands directories into the *.obj files below them, in sorted order
+bool collect_inputs(const std::vector<std::string>& paths, std::vector<std::string>& files) {
+    namespace fs = std::filesystem;
+
+    bool ok = true;
+    for (const auto& path : paths) {
+        std::error_code ec;
+        if (!fs::is_directory(path, ec)) {
+            files.push_back(path);  // Missing files are reported by the loader
+            continue;
+        }
+
+        std::vector<std::string> found;
+        fs::recursive_directory_iterator it(path, fs::directory_options::skip_permission_denied, ec);
+        for (const fs::recursive_directory_iterator end; !ec && it != end; it.increment(ec)) {
+            std::error_code type_ec;
+            if (it->path().extension() == ".obj" && it->is_regular_file(type_ec)) {
+                found.push_back(it->path().string());
+            }
+        }
+        if (ec) {
+            std::cerr << "Error: Could not scan directory " << path << ": " << ec.message()
+                      << std::endl;
+            ok = false;
+        }
+        std::sort(found.begin(), found.end());
+        files.insert(files.end(), found.begin(), found.end());
+    }
+    return ok;
+}
+
+}  // namespace
+
+bool dump_objects(const DumpOptions& options) {
+    std::vector<std::string> files;
+    bool ok = collect_inputs(options.paths, files);
+
+    // Each object is formatted on the thread that loaded it and then dropped,
+    // so a whole tree never has to be resident at once.
+    TaskScheduler scheduler(options.threads);
+    std::vector<LoadedObject> objects(files.size());
+    std::vector<std::string> errors(files.size());
+    std::vector<DumpedObject> dumped(files.size());
+    // --duplicates on its own prints just the report, not every object
+    const bool listing = !options.duplicates || options.summary || options.json;
+    load_object_files(files, objects, errors, scheduler, options.io_uring, [&](size_t i, bool loaded) {
+        DumpedObject& result = dumped[i];
+        if (!loaded) {
+            result.error = errors[i];
+            while (!result.error.empty() && result.error.back() == '\n') result.error.pop_back();
+            return;
+        }
+
+        const LoadedObject& obj = objects[i];
+        result.counts = count_object(obj);
+        std::ostringstream out;
+        if (options.json) {
+            format_json(out, files[i], obj, result.counts, options.summary);
+        } else if (options.summary) {
+            format_summary_text(out, files[i], result.counts);
+        } else if (listing) {
+            format_text(out, files[i], obj, options.width);
+        }
+        result.text = out.str();
+
+        if (options.duplicates) {
+            for (const auto& sym : obj.symbols) {
+                if (sym.type == SYMBOL_DEFINED) result.defined.push_back(field_string(sym.name));
+            }
+        }
+        objects[i] = LoadedObject();
+    });
+
+    // Merged in input order so the report does not depend on thread timing
+    std::map<std::string, std::vector<size_t>> definitions;
+    for (size_t i = 0; i < files.size(); ++i) {
+        for (const auto& name : dumped[i].defined) {
+            std::vector<size_t>& where = definitions[name];
+            if (where.empty() || where.back() != i) where.push_back(i);
+        }
+    }
+    for (auto it = definitions.begin(); it != definitions.end();) {
+        it = it->second.size() > 1 ? std::next(it) : definitions.erase(it);
+    }
+
+    ObjectCounts totals;
+    for (const auto& result : dumped) {
+        if (result.error.empty()) {
+            totals.add(result.counts);
+        } else {
+            ok = false;
+        }
+    }
+
+    std::ostream& out = std::cout;
+    if (options.json) {
+        out << "{\n  \"objects\": [";
+        bool first = true;
+        for (size_t i = 0; i < files.size(); ++i) {
+            if (!dumped[i].error.empty()) continue;
+            out << (first ? "\n" : ",\n") << dumped[i].text;
+            first = false;
+        }
+        out << "\n  ],\n  \"errors\": [";
+        first = true;
+        for (size_t i = 0; i < files.size(); ++i) {
+            if (dumped[i].error.empty()) continue;
+            out << (first ? "\n" : ",\n") << "    {\"file\": ";
+            write_json_string(out, files[i]);
+            out << ", \"message\": ";
+            write_json_string(out, dumped[i].error);
+            out << "}";
+            first = false;
+        }
+        out << "\n  ]";
+        if (options.summary) {
+            out << ",\n  \"totals\": {";
+            write_json_counts(out, totals);
+            out << "}";
+        }
+        if (options.duplicates) {
+            out << ",\n  \"duplicates\": [";
+            first = true;
+            for (const auto& entry : definitions) {
+                out << (first ? "\n" : ",\n") << "    {\"name\": ";
+                write_json_string(out, entry.first);
+                out << ", \"files\": [";
+                for (size_t k = 0; k < entry.second.size(); ++k) {
+                    if (k) out << ", ";
+                    write_json_string(out, files[entry.second[k]]);
+                }
+                out << "]}";
+                first = false;
+            }
+            out << "\n  ]";
+        }
+        out << "\n}\n";
+    } else {
+        if (options.summary) {
+            out << "     text     data    sdata      bss  symbols  undef  relocs  file\n";
+        }
+        for (size_t i = 0; i < files.size(); ++i) {
+            if (!dumped[i].error.empty()) {
+                std::cerr << dumped[i].error << std::endl;
+            } else {
+                out << dumped[i].text;
+            }
+        }
+        if (options.summary) {
+            format_summary_text(out, "total", totals);
+        }
+        if (options.duplicates) {
+            out << (definitions.empty() ? "No duplicate symbols\n" : "Duplicate symbols:\n");
+            for (const auto& entry : definitions) {
+                out << "  " << entry.first << ":";
+                for (size_t index : entry.second) out << " " << files[index];
+                out << "\n";
+            }
+        }
+    }
+    out.flush();
+
+    return ok && definitions.empty();
+}
@@ -0,0 +1,375 @@
+#include "ObjectLoader.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+#include "Checksum.h"
+#include "Compression.h"
+#include "UringReader.h"
+
+namespace {
+
+// Bounds-checked cursor over an in-memory object file
+struct ByteReader {
+    const uint8_t* data;
+    size_t size;
+    size_t pos = 0;
+
+    const uint8_t* take(size_t count) {
+        if (count > size - pos) return nullptr;
+        const uint8_t* p = data + pos;
+        pos += count;
+        return p;
+    }
+};
+
+enum PartStatus {
+    PART_OK,
+    PART_TRUNCATED,
+    PART_CORRUPT,       // LZ4 block does not decode to the expected size
+    PART_BAD_CHECKSUM,
+};
+
+// How each stored part is encoded, from the header flags
+struct PartFormat {
+    bool compressed = false;
+    bool checksummed = false;
+};
+
+// Reads one stored part (section or table) into `dst` and sets `crc` to the
+// CRC32C of its stored bytes. Compressed objects store each part as a 32-bit
+// compressed length followed by an LZ4 block, which is decoded straight into
+// the destination buffer. With checksums, the stored bytes are verified
+// before they are used: plain parts in the same loop that copies them,
+// compressed blocks before they are decoded. Without, the CRC is still taken
+// in the copy loop, as the identity of the input (LoadedObject::content_hash).
+PartStatus read_part(ByteReader& in, const PartFormat& format, uint32_t expected_crc,
+                     uint8_t* dst, size_t size, uint32_t& crc) {
+    if (!format.compressed) {
+        const uint8_t* src = in.take(size);
+        if (!src) return PART_TRUNCATED;
+        crc = crc32c_copy(dst, src, size);
+        if (format.checksummed && crc != expected_crc) return PART_BAD_CHECKSUM;
+        return PART_OK;
+    }
+
+    const uint8_t* len_bytes = in.take(sizeof(uint32_t));
+    if (!len_bytes) return PART_TRUNCATED;
+    uint32_t compressed_size = 0;
+    memcpy(&compressed_size, len_bytes, sizeof(compressed_size));
+
+    const uint8_t* src = in.take(compressed_size);
+    if (!src) return PART_TRUNCATED;
+    crc = crc32c(src, compressed_size);
+    if (format.checksummed && crc != expected_crc) {
+        return PART_BAD_CHECKSUM;
+    }
+    return lz4_decompress_block(src, compressed_size, dst, size) ? PART_OK : PART_CORRUPT;
+}
+
+// Checks that a part decoding to `size` bytes can come from what is left of
+// the input, before anything is allocated for it: header sizes are not
+// trusted. A compressed block must be present in full and cannot decode to
+// more than LZ4_MAX_RATIO times its stored length.
+PartStatus check_part_size(const ByteReader& in, const PartFormat& format, uint64_t size) {
+    size_t left = in.size - in.pos;
+    if (!format.compressed) {
+        return size <= left ? PART_OK : PART_TRUNCATED;
+    }
+
+    uint32_t compressed_size = 0;
+    if (left < sizeof(compressed_size)) return PART_TRUNCATED;
+    memcpy(&compressed_size, in.data + in.pos, sizeof(compressed_size));
+    if (compressed_size > left - sizeof(compressed_size)) return PART_TRUNCATED;
+    return size <= compressed_size * LZ4_MAX_RATIO ? PART_OK : PART_CORRUPT;
+}
+
+// Sizes `section` to `size` bytes once the input can hold them, and reads it
+PartStatus read_section(ByteReader& in, const PartFormat& format, uint32_t expected_crc,
+                        uint32_t size, std::vector<uint8_t>& section, uint32_t& crc) {
+    PartStatus status = check_part_size(in, format, size);
+    if (status != PART_OK) {
+        section.clear();
+        return status;
+    }
+    section.resize(size);
+    return read_part(in, format, expected_crc, section.data(), section.size(), crc);
+}
+
+// Reads `count` entries stored with `stride` bytes each into `entries`.
+// Shorter on-disk entries are zero-extended, longer ones have their unknown
+// tail skipped.
+template <typename Entry>
+PartStatus read_entry_table(ByteReader& in, const PartFormat& format, uint32_t expected_crc,
+                            uint32_t count, uint32_t stride, std::vector<Entry>& entries,
+                            uint32_t& crc) {
+    // Both factors are 32-bit, so the 64-bit product cannot overflow
+    PartStatus status = check_part_size(in, format, static_cast<uint64_t>(count) * stride);
+    if (status != PART_OK) {
+        entries.clear();
+        return status;
+    }
+    entries.assign(count, Entry());
+
+    if (stride == sizeof(Entry)) {
+        return read_part(in, format, expected_crc, reinterpret_cast<uint8_t*>(entries.data()),
+                         static_cast<size_t>(count) * stride, crc);
+    }
+
+    std::vector<uint8_t> raw(static_cast<size_t>(count) * stride);
+    status = read_part(in, format, expected_crc, raw.data(), raw.size(), crc);
+    if (status != PART_OK) {
+        return status;
+    }
+    size_t copy_size = std::min<size_t>(stride, sizeof(Entry));
+    for (size_t i = 0; i < count; ++i) {
+        memcpy(&entries[i], raw.data() + i * stride, copy_size);
+    }
+    return PART_OK;
+}
+
+bool report_part(PartStatus status, const char* what, const std::string& name,
+                 std::ostream& err) {
+    switch (status) {
+    case PART_OK:
+        return true;
+    case PART_TRUNCATED:
+        err << "Error: Truncated object file " << name << " (in " << what << ")" << std::endl;
+        break;
+    case PART_CORRUPT:
+        err << "Error: Corrupt compressed " << what << " in " << name << std::endl;
+        break;
+    case PART_BAD_CHECKSUM:
+        err << "Error: Checksum mismatch in " << what << " of " << name << std::endl;
+        break;
+    }
+    return false;
+}
+
+// Maps a file read-only. Returns false (without a message) if mapping is not
+// possible, e.g. for an empty file or a pipe, so the caller can fall back.
+bool map_file(int fd, const uint8_t*& data, size_t& size) {
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size <= 0) {
+        return false;
+    }
+    void* addr = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    if (addr == MAP_FAILED) {
+        return false;
+    }
+    madvise(addr, static_cast<size_t>(st.st_size), MADV_SEQUENTIAL);
+    data = static_cast<const uint8_t*>(addr);
+    size = static_cast<size_t>(st.st_size);
+    return true;
+}
+
+// Reads until end of file. Fails on read errors, e.g. EISDIR for a directory.
+bool read_to_end(int fd, std::vector<uint8_t>& buffer) {
+    const size_t CHUNK = 64 * 1024;
+    size_t used = 0;
+    while (true) {
+        buffer.resize(used + CHUNK);
+        ssize_t got = read(fd, buffer.data() + used, CHUNK);
+        if (got < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        if (got == 0) break;
+        used += static_cast<size_t>(got);
+    }
+    buffer.resize(used);
+    return true;
+}
+
+}  // namespace
+
+bool parse_object_buffer(const uint8_t* data, size_t size, const std::string& name,
+                         LoadedObject& obj, std::ostream& err) {
+    ByteReader in{data, size};
+    obj.filename = name;
+
+    // Read Header
+    obj.header = FileHeader();
+    const uint8_t* header = in.take(FILE_HEADER_V1_SIZE);
+    if (!header) {
+        err << "Error: File too small to contain a header: " << name << std::endl;
+        return false;
+    }
+    memcpy(&obj.header, header, FILE_HEADER_V1_SIZE);
+
+    uint32_t symbol_entry_size = SYMBOL_ENTRY_V1_SIZE;
+    uint32_t reloc_entry_size = RELOC_ENTRY_V1_SIZE;
+    if (obj.header.magic == LINKER_MAGIC_V2) {
+        uint32_t header_size = 0;
+        const uint8_t* size_bytes = in.take(sizeof(header_size));
+        if (size_bytes) memcpy(&header_size, size_bytes, sizeof(header_size));
+        if (header_size < FILE_HEADER_V1_SIZE + sizeof(header_size)) {
+            err << "Error: Invalid header size in " << name << std::endl;
+            return false;
+        }
+
+        // Rest of the header, zero-extended or truncated to what we know
+        uint32_t consumed = FILE_HEADER_V1_SIZE + sizeof(header_size);
+        const uint8_t* rest = in.take(header_size - consumed);
+        if (!rest) {
+            err << "Error: Truncated header in " << name << std::endl;
+            return false;
+        }
+        uint32_t known = std::min<uint32_t>(header_size, sizeof(FileHeader));
+        if (known > consumed) {
+            memcpy(reinterpret_cast<uint8_t*>(&obj.header) + consumed, rest, known - consumed);
+        }
+        obj.header.header_size = header_size;
+
+        symbol_entry_size = obj.header.symbol_entry_size;
+        reloc_entry_size = obj.header.reloc_entry_size;
+        if (symbol_entry_size < SYMBOL_ENTRY_V1_SIZE || reloc_entry_size < RELOC_ENTRY_V1_SIZE) {
+            err << "Error: Invalid table entry size in " << name << std::endl;
+            return false;
+        }
+    } else if (obj.header.magic != LINKER_MAGIC) {
+        err << "Error: Invalid magic number in " << name << std::endl;
+        return false;
+    }
+
+    size_t header_bytes = in.pos;
+    PartFormat format;
+    format.compressed = (obj.header.flags & OBJ_FLAG_COMPRESSED) != 0;
+    format.checksummed = (obj.header.flags & OBJ_FLAG_CHECKSUMS) != 0;
+    if (format.checksummed && obj.header.header_size < sizeof(FileHeader)) {
+        err << "Error: Checksum flag set but header too short in " << name << std::endl;
+        return false;
+    }
+
+    // Sections, then Symbols, then Relocations
+    const FileHeader& h = obj.header;
+    uint32_t crcs[6] = {};
+    bool ok =
+        report_part(read_section(in, format, h.text_crc, h.text_size, obj.text_section, crcs[0]),
+                    "text section", name, err) &&
+        report_part(read_section(in, format, h.data_crc, h.data_size, obj.data_section, crcs[1]),
+                    "data section", name, err) &&
+        report_part(read_section(in, format, h.sdata_crc, h.sdata_size, obj.sdata_section,
+                                 crcs[2]),
+                    "sdata section", name, err) &&
+        report_part(read_entry_table(in, format, h.symtable_crc, h.symtable_count,
+                                     symbol_entry_size, obj.symbols, crcs[3]),
+                    "symbol table", name, err) &&
+        report_part(read_entry_table(in, format, h.reloc_crc, h.reloc_count,
+                                     reloc_entry_size, obj.relocs, crcs[4]),
+                    "relocation table", name, err);
+    if (!ok) return false;
+
+    // The part CRCs plus the raw header cover every byte that was read
+    crcs[5] = crc32c(data, header_bytes);
+    obj.content_hash = (static_cast<uint64_t>(size) << 32) |
+                       crc32c(reinterpret_cast<const uint8_t*>(crcs), sizeof(crcs));
+    return true;
+}
+
+bool load_object_file(const std::string& path, LoadedObject& obj, std::ostream& err) {
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        err << "Error: Could not open file " << path << std::endl;
+        return false;
+    }
+    return load_object_fd(fd, path, obj, err);
+}
+
+bool load_object_fd(int fd, const std::string& path, LoadedObject& obj, std::ostream& err) {
+    // Map the file so parsing (and checksumming) reads the page cache directly
+    const uint8_t* mapped = nullptr;
+    size_t mapped_size = 0;
+    if (map_file(fd, mapped, mapped_size)) {
+        close(fd);
+        bool ok = parse_object_buffer(mapped, mapped_size, path, obj, err);
+        munmap(const_cast<uint8_t*>(mapped), mapped_size);
+        return ok;
+    }
+
+    // Fallback for what cannot be mapped (empty files, pipes): read to EOF
+    std::vector<uint8_t> buffer;
+    bool read_ok = read_to_end(fd, buffer);
+    close(fd);
+    if (!read_ok) {
+        err << "Error: Could not read file " << path << std::endl;
+        return false;
+    }
+    return parse_object_buffer(buffer.data(), buffer.size(), path, obj, err);
+}
+
+void load_object_files(const std::vector<std::string>& paths,
+                       std::vector<LoadedObject>& objects,
+                       std::vector<std::string>& errors,
+                       TaskScheduler& scheduler,
+                       bool use_io_uring,
+                       const std::function<void(size_t, bool)>& on_done,
+                       UringReader* reader) {
+    auto load_one = [&](size_t i) {
+        std::ostringstream err;
+        bool ok = load_object_file(paths[i], objects[i], err);
+        if (!ok) errors[i] = err.str();
+        on_done(i, ok);
+    };
+
+    UringReader own_reader;
+    if (use_io_uring && !reader && own_reader.init()) {
+        reader = &own_reader;
+    }
+    if (!use_io_uring || !reader) {
+        scheduler.parallel_for(paths.size(), 1, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) load_one(i);
+        });
+        return;
+    }
+
+    // Batches are read in link order so early objects reach the resolver
+    // first; each batch is parsed in parallel before the arena is reused.
+    std::vector<const std::string*> batch;
+    std::vector<UringReader::FileData> results;
+    for (size_t first = 0; first < paths.size(); first += batch.size()) {
+        size_t count = std::min(reader->batch_capacity(), paths.size() - first);
+        batch.clear();
+        for (size_t i = 0; i < count; ++i) {
+            batch.push_back(&paths[first + i]);
+        }
+
+        if (!reader->read_batch(batch, results)) {
+            // Ring failure: finish this and every later file the plain way
+            scheduler.parallel_for(paths.size() - first, 1, [&](size_t begin, size_t end) {
+                for (size_t i = begin; i < end; ++i) load_one(first + i);
+            });
+            return;
+        }
+
+        scheduler.parallel_for(count, 1, [&](size_t begin, size_t end) {
+            for (size_t k = begin; k < end; ++k) {
+                size_t i = first + k;
+                const UringReader::FileData& file = results[k];
+                std::ostringstream err;
+                bool ok = false;
+                if (!file.in_arena) {
+                    // Pipes, and files too large for the arena: mapped or
+                    // read from the descriptor already open
+                    ok = load_object_fd(file.fd, paths[i], objects[i], err);
+                } else if (file.error) {
+                    err << "Error: Could not " << (file.open_failed ? "open" : "read") << " file "
+                        << paths[i] << std::endl;
+                } else {
+                    ok = parse_object_buffer(file.data, file.size, paths[i], objects[i], err);
+                }
+                if (!ok) errors[i] = err.str();
+                on_done(i, ok);
+            }
+        });
+    }
+}
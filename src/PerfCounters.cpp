@@ -0,0 +1,84 @@
+#include "PerfCounters.h"
+
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+
+const char* const PERF_EVENT_NAMES[PERF_EVENT_COUNT] = {
+    "cycles", "instructions", "cache_misses", "branch_misses", "task_clock_ns",
+};
+
+namespace {
+
+struct EventConfig {
+    uint32_t type;
+    uint64_t config;
+};
+
+const EventConfig EVENT_CONFIGS[PERF_EVENT_COUNT] = {
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+    {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_TASK_CLOCK},
+};
+
+int perf_event_open(perf_event_attr* attr, pid_t tid) {
+    return static_cast<int>(syscall(__NR_perf_event_open, attr, tid, -1, -1, PERF_FLAG_FD_CLOEXEC));
+}
+
+}  // namespace
+
+ThreadCounters::~ThreadCounters() {
+    for (int fd : fds_) {
+        if (fd >= 0) close(fd);
+    }
+}
+
+bool ThreadCounters::open(pid_t tid, int& error) {
+    error = 0;
+    bool any = false;
+    for (int e = 0; e < PERF_EVENT_COUNT; ++e) {
+        perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = EVENT_CONFIGS[e].type;
+        attr.config = EVENT_CONFIGS[e].config;
+        attr.exclude_kernel = 1;  // Allowed at perf_event_paranoid <= 2
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+        fds_[e] = perf_event_open(&attr, tid);
+        if (fds_[e] >= 0) {
+            any = true;
+        } else if (error == 0) {
+            error = errno;
+        }
+    }
+    return any;
+}
+
+PerfSample ThreadCounters::read() const {
+    PerfSample sample;
+    for (int e = 0; e < PERF_EVENT_COUNT; ++e) {
+        if (fds_[e] < 0) continue;
+
+        uint64_t data[3];  // value, time enabled, time running
+        if (::read(fds_[e], data, sizeof(data)) != static_cast<ssize_t>(sizeof(data))) continue;
+
+        uint64_t value = data[0];
+        if (data[2] > 0 && data[2] < data[1]) {
+            value = static_cast<uint64_t>(static_cast<double>(value) * data[1] / data[2]);
+        }
+        sample.values[e] = value;
+        sample.valid[e] = true;
+    }
+    return sample;
+}
+
+pid_t current_thread_id() {
+    return static_cast<pid_t>(syscall(SYS_gettid));
+}
@@ -0,0 +1,128 @@
+#include "SharedImage.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+namespace {
+
+bool parse_address(const std::string& text, uint64_t limit, uint64_t& value) {
+    try {
+        size_t consumed = 0;
+        value = std::stoull(text, &consumed, 0);
+        return consumed == text.size() && value <= limit;
+    } catch (const std::exception&) {
+        return false;
+    }
+}
+
+}  // namespace
+
+bool read_shared_image(const std::string& path, SharedImage& image) {
+    std::ifstream file(path);
+    if (!file) {
+        std::cerr << "Error: Could not open shared image symbols " << path << std::endl;
+        return false;
+    }
+
+    image = SharedImage();
+    image.symbols_path = path;
+
+    bool have_image = false;
+    std::string line;
+    int line_no = 0;
+    while (std::getline(file, line)) {
+        ++line_no;
+        size_t comment = line.find('#');
+        if (comment != std::string::npos) {
+            line.erase(comment);
+        }
+
+        std::istringstream iss(line);
+        std::string keyword;
+        if (!(iss >> keyword)) continue;
+
+        std::string a, b;
+        uint64_t first = 0, second = 0;
+        bool ok = false;
+        if (keyword == "image") {
+            ok = (iss >> a >> b) && parse_address(a, UINT32_MAX, first) &&
+                 parse_address(b, 0x100000000ULL - first, second);
+            std::getline(iss >> std::ws, image.image_path);
+            ok = ok && !image.image_path.empty();
+            image.image_base = static_cast<uint32_t>(first);
+            image.image_size = static_cast<uint32_t>(second);
+            have_image = true;
+        } else if (keyword == "range" || keyword == "bss") {
+            ok = (iss >> a >> b) && parse_address(a, UINT32_MAX, first) &&
+                 parse_address(b, 0x100000000ULL, second) && first <= second;
+            if (keyword == "range") {
+                image.ranges.emplace_back(first, second);
+            } else {
+                image.bss_start = static_cast<uint32_t>(first);
+                image.bss_end = static_cast<uint32_t>(second);
+            }
+        } else if (keyword == "symbol") {
+            ok = (iss >> a >> b) && parse_address(b, UINT32_MAX, second);
+            if (ok && !image.symbols.emplace(a, static_cast<uint32_t>(second)).second) {
+                std::cerr << "Error: " << path << ":" << line_no << ": symbol '" << a
+                          << "' listed twice" << std::endl;
+                return false;
+            }
+        } else {
+            std::cerr << "Error: " << path << ":" << line_no << ": unknown keyword '" << keyword
+                      << "'" << std::endl;
+            return false;
+        }
+
+        if (!ok) {
+            std::cerr << "Error: " << path << ":" << line_no << ": malformed '" << keyword
+                      << "' record" << std::endl;
+            return false;
+        }
+    }
+
+    if (!have_image) {
+        std::cerr << "Error: " << path << ": no 'image' record" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool write_shared_image(const std::string& path, const SharedImage& image) {
+    std::ofstream out(path);
+    if (!out) {
+        std::cerr << "Error: Could not open shared image symbols " << path << std::endl;
+        return false;
+    }
+
+    out << "# Shared image symbols written by mllinker --shared\n" << std::hex << std::setfill('0');
+    out << "image 0x" << std::setw(8) << image.image_base << " 0x" << std::setw(8)
+        << image.image_size << " " << image.image_path << "\n";
+    for (const auto& range : image.ranges) {
+        out << "range 0x" << std::setw(8) << range.first << " 0x" << std::setw(8) << range.second
+            << "\n";
+    }
+    if (image.bss_end > image.bss_start) {
+        out << "bss 0x" << std::setw(8) << image.bss_start << " 0x" << std::setw(8)
+            << image.bss_end << "\n";
+    }
+    for (const auto& symbol : image.symbols) {
+        out << "symbol " << symbol.first << " 0x" << std::setw(8) << symbol.second << "\n";
+    }
+
+    if (!out) {
+        std::cerr << "Error: Failed writing shared image symbols " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool shared_image_overlaps(const SharedImage& image, uint64_t start, uint64_t end) {
+    for (const auto& range : image.ranges) {
+        if (std::max(start, range.first) < std::min(end, range.second)) return true;
+    }
+    return false;
+}
@@ -0,0 +1,145 @@
+#include "SizeReport.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+#include "JsonOutput.h"
+
+namespace {
+
+const uint32_t REPORT_SECTIONS[] = {SECTION_TEXT, SECTION_DATA, SECTION_SDATA, SECTION_BSS};
+
+const char* section_key(uint32_t section) {
+    switch (section) {
+        case SECTION_TEXT: return "text";
+        case SECTION_DATA: return "data";
+        case SECTION_SDATA: return "sdata";
+        case SECTION_BSS: return "bss";
+    }
+    return "?";
+}
+
+struct SymbolExtent {
+    const SymbolEntry* sym;
+    uint32_t size;
+    bool inferred;
+};
+
+// Definitions of one section of `obj`, ordered by offset, with extents
+std::vector<SymbolExtent> section_symbols(const LoadedObject& obj, uint32_t section) {
+    std::vector<const SymbolEntry*> defs;
+    for (const auto& sym : obj.symbols) {
+        if ((sym.type == SYMBOL_DEFINED || sym.type == SYMBOL_WEAK) && sym.section == section) {
+            defs.push_back(&sym);
+        }
+    }
+    std::stable_sort(defs.begin(), defs.end(), [](const SymbolEntry* a, const SymbolEntry* b) {
+        return a->offset < b->offset;
+    });
+
+    uint32_t section_end = section_size(obj, section);
+    std::vector<SymbolExtent> extents;
+    for (size_t i = 0; i < defs.size(); ++i) {
+        SymbolExtent extent{defs[i], defs[i]->size, false};
+        if (extent.size == 0) {
+            // Up to the next symbol at a higher offset, else the section end
+            uint32_t next = section_end;
+            for (size_t k = i + 1; k < defs.size(); ++k) {
+                if (defs[k]->offset > defs[i]->offset) {
+                    next = defs[k]->offset;
+                    break;
+                }
+            }
+            extent.size = next > defs[i]->offset ? next - defs[i]->offset : 0;
+            extent.inferred = true;
+        }
+        extents.push_back(extent);
+    }
+    return extents;
+}
+
+}  // namespace
+
+bool write_size_report(const std::string& path,
+                       const std::vector<LoadedObject>& objects,
+                       const std::vector<ObjectReason>& reasons,
+                       const SymbolTable& global_symbol_table) {
+    std::ofstream out(path);
+    if (!out) {
+        std::cerr << "Error: Could not open size report file " << path << std::endl;
+        return false;
+    }
+
+    uint64_t totals[4] = {};
+    uint64_t total_padding = 0;
+    for (const auto& obj : objects) {
+        for (int s = 0; s < 4; ++s) totals[s] += section_size(obj, REPORT_SECTIONS[s]);
+        total_padding += obj.text_padding;
+    }
+
+    out << "{\n  \"totals\": {";
+    for (int s = 0; s < 4; ++s) {
+        out << "\"" << section_key(REPORT_SECTIONS[s]) << "\": " << totals[s] << ", ";
+    }
+    out << "\"text_padding\": " << total_padding << "},\n  \"objects\": [";
+
+    for (size_t i = 0; i < objects.size(); ++i) {
+        const LoadedObject& obj = objects[i];
+        const ObjectReason& reason = reasons[i];
+
+        out << (i ? "," : "") << "\n    {\"file\": ";
+        write_json_string(out, obj.filename);
+        out << ",\n     \"activated_by\": ";
+        if (reason.generated) {
+            out << "null";
+        } else {
+            out << "{\"symbol\": ";
+            write_json_string(out, reason.symbol);
+            out << ", \"needed_by\": ";
+            if (reason.needed_by.empty()) {
+                out << "null";
+            } else {
+                write_json_string(out, reason.needed_by);
+            }
+            out << "}";
+        }
+
+        uint64_t object_total = 0;
+        out << ",\n     ";
+        for (uint32_t section : REPORT_SECTIONS) {
+            uint32_t size = section_size(obj, section);
+            object_total += size;
+            out << "\"" << section_key(section) << "\": " << size << ", ";
+        }
+        out << "\"text_padding\": " << obj.text_padding << ", \"total\": " << object_total;
+
+        out << ",\n     \"symbols\": [";
+        bool first = true;
+        for (uint32_t section : REPORT_SECTIONS) {
+            for (const auto& extent : section_symbols(obj, section)) {
+                std::string name(extent.sym->name, strnlen(extent.sym->name, sizeof(extent.sym->name)));
+                uint32_t address = section_base(obj, section) + extent.sym->offset;
+                const uint32_t* entry = global_symbol_table.find(name);
+                bool used = entry && *entry == address;
+
+                out << (first ? "\n       " : ",\n       ") << "{\"name\": ";
+                write_json_string(out, name);
+                out << ", \"section\": \"" << section_key(section) << "\", \"address\": " << address
+                    << ", \"size\": " << extent.size << ", \"size_source\": \""
+                    << (extent.inferred ? "inferred" : "entry") << "\", \"used\": "
+                    << (used ? "true" : "false") << "}";
+                first = false;
+            }
+        }
+        out << "]}";
+    }
+    out << "\n  ]\n}\n";
+
+    if (!out) {
+        std::cerr << "Error: Failed writing size report " << path << std::endl;
+        return false;
+    }
+    return true;
+}
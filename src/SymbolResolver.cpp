@@ -0,0 +1,220 @@
+#include "SymbolResolver.h"
+
+#include <algorithm>
+
+void SymbolResolver::Symbol::reset(uint32_t current_link) {
+    state = SymbolState::UNDEFINED;
+    needed = false;
+    strong = false;
+    common = false;
+    imported = false;
+    needed_by = NO_OBJECT;
+    weak_provider = NO_OBJECT;
+    lazy_member = NO_MEMBER;
+    common_size = CommonSymbol();
+    waiting.clear();
+    link = current_link;
+}
+
+void SymbolResolver::reset(bool record_activations) {
+    ++link_;
+    live_.clear();
+    weak_names_.clear();
+    objects_.clear();
+    active_.clear();
+    fetched_.clear();
+    worklist_.clear();
+    fetcher_ = nullptr;
+    failed_ = false;
+    needed_.clear();
+    strong_names_.clear();
+    commons_.clear();
+    imports_.clear();
+    link_every_object_ = false;
+    record_activations_ = record_activations;
+    activations_.clear();
+}
+
+void SymbolResolver::add_root(const std::string& name) {
+    need(intern(name.c_str()), NO_OBJECT);
+    drain();
+}
+
+void SymbolResolver::add_import(const std::string& name, uint32_t address) {
+    imports_[name] = address;
+    symbols_[intern(name.c_str())].imported = true;
+}
+
+SymbolResolver::SymbolId SymbolResolver::intern(const char* name) {
+    lookup_.assign(name);
+    auto it = ids_.find(lookup_);
+    if (it == ids_.end()) {
+        it = ids_.emplace(lookup_, static_cast<SymbolId>(symbols_.size())).first;
+        symbols_.emplace_back();
+        symbols_.back().name = lookup_;
+    }
+
+    // First use in this link: drop what an earlier link left behind
+    Symbol& symbol = symbols_[it->second];
+    if (symbol.link != link_) {
+        symbol.reset(link_);
+        live_.push_back(it->second);
+    }
+    return it->second;
+}
+
+void SymbolResolver::add_object(const LoadedObject& obj, size_t index) {
+    register_object(obj, index);
+    drain();
+}
+
+void SymbolResolver::register_object(const LoadedObject& obj, size_t index) {
+    if (objects_.size() <= index) {
+        objects_.resize(index + 1, nullptr);
+        active_.resize(index + 1, false);
+    }
+    objects_[index] = &obj;
+
+    if (link_every_object_) {
+        for (const auto& sym : obj.symbols) {
+            if (sym.type == SYMBOL_DEFINED || sym.type == SYMBOL_WEAK) {
+                need(intern(sym.name), NO_OBJECT);
+            }
+        }
+    }
+
+    for (const auto& sym : obj.symbols) {
+        if (sym.type != SYMBOL_DEFINED && sym.type != SYMBOL_COMMON && sym.type != SYMBOL_WEAK) {
+            continue;
+        }
+        SymbolId id = intern(sym.name);
+        Symbol& symbol = symbols_[id];
+        symbol.state = SymbolState::DEFINED;
+        symbol.lazy_member = NO_MEMBER;
+
+        if (sym.type == SYMBOL_DEFINED) {
+            symbol.strong = true;
+            if (symbol.needed) {
+                activate(index, id);
+            } else {
+                symbol.waiting.push_back(index);
+            }
+        } else if (sym.type == SYMBOL_COMMON) {
+            symbol.common = true;
+            symbol.common_size.size = std::max(symbol.common_size.size, sym.size);
+            symbol.common_size.align = std::max(symbol.common_size.align, sym.align);
+        } else if (symbol.weak_provider == NO_OBJECT) {
+            symbol.weak_provider = index;
+            weak_names_.push_back(id);
+        }
+    }
+}
+
+void SymbolResolver::add_lazy_symbol(const char* name, uint32_t member) {
+    if (fetched_.size() <= member) {
+        fetched_.resize(member + 1, false);
+    }
+    SymbolId id = intern(name);
+    Symbol& symbol = symbols_[id];
+    if (symbol.imported || symbol.state != SymbolState::UNDEFINED) return;
+
+    symbol.state = SymbolState::LAZY;
+    symbol.lazy_member = member;
+    if (symbol.needed) {
+        fetch(member, id);
+        drain();
+    }
+}
+
+void SymbolResolver::finish() {
+    // Each weak activation can add needs that only another weak provider
+    // satisfies, so repeat until nothing changes. Names are visited in
+    // order so activation reasons do not depend on the link line.
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        std::vector<SymbolId> weak = weak_names_;
+        std::sort(weak.begin(), weak.end(), [this](SymbolId a, SymbolId b) {
+            return symbols_[a].name < symbols_[b].name;
+        });
+        for (SymbolId id : weak) {
+            const Symbol& symbol = symbols_[id];
+            if (active_[symbol.weak_provider] || !symbol.needed || symbol.strong || symbol.common ||
+                symbol.imported) {
+                continue;
+            }
+            activate(symbol.weak_provider, id);
+            drain();
+            changed = true;
+        }
+    }
+
+    for (SymbolId id : live_) {
+        const Symbol& symbol = symbols_[id];
+        if (symbol.needed && !symbol.imported) needed_.insert(symbol.name);
+        if (symbol.strong) strong_names_.insert(symbol.name);
+        if (symbol.common) commons_.emplace(symbol.name, symbol.common_size);
+    }
+}
+
+void SymbolResolver::need(SymbolId id, size_t needed_by) {
+    Symbol& symbol = symbols_[id];
+    if (symbol.needed) return;
+    symbol.needed = true;
+    symbol.needed_by = needed_by;
+
+    if (symbol.state == SymbolState::LAZY) {
+        fetch(symbol.lazy_member, id);
+        return;
+    }
+    std::vector<size_t> waiting;
+    waiting.swap(symbol.waiting);
+    for (size_t index : waiting) {
+        activate(index, id);
+    }
+}
+
+void SymbolResolver::fetch(uint32_t member, SymbolId id) {
+    if (fetched_[member] || failed_) return;
+    fetched_[member] = true;
+
+    const LoadedObject* obj = nullptr;
+    size_t index = 0;
+    if (!fetcher_ || !fetcher_(member, obj, index)) {
+        failed_ = true;
+        return;
+    }
+    // Activate first so the reason is the name that pulled the member in,
+    // even if the member only defines it weakly
+    if (objects_.size() <= index) {
+        objects_.resize(index + 1, nullptr);
+        active_.resize(index + 1, false);
+    }
+    objects_[index] = obj;
+    activate(index, id);
+    register_object(*obj, index);
+}
+
+void SymbolResolver::activate(size_t index, SymbolId id) {
+    if (active_[index]) return;
+    active_[index] = true;
+    worklist_.push_back(index);
+
+    if (record_activations_) {
+        if (activations_.size() <= index) {
+            activations_.resize(index + 1);
+        }
+        activations_[index].symbol = symbols_[id].name;
+        activations_[index].needed_by = symbols_[id].needed_by;
+    }
+}
+
+void SymbolResolver::drain() {
+    while (!worklist_.empty()) {
+        size_t index = worklist_.back();
+        worklist_.pop_back();
+        for (const auto& reloc : objects_[index]->relocs) {
+            need(intern(reloc.symbol_name), index);
+        }
+    }
+}
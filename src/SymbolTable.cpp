@@ -0,0 +1,21 @@
+#include "SymbolTable.h"
+
+void SymbolTable::clear() {
+    for (auto& shard : shards_) {
+        shard.clear();
+    }
+}
+
+const uint32_t* SymbolTable::find(const std::string& name) const {
+    const Shard& shard = shards_[shard_of(name)];
+    auto it = shard.find(name);
+    return it != shard.end() ? &it->second : nullptr;
+}
+
+size_t SymbolTable::size() const {
+    size_t total = 0;
+    for (const auto& shard : shards_) {
+        total += shard.size();
+    }
+    return total;
+}
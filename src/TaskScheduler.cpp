@@ -0,0 +1,171 @@
+#include "TaskScheduler.h"
+
+#include <algorithm>
+
+#include "PerfCounters.h"
+
+namespace {
+
+// Queue index of the current thread within the scheduler it belongs to
+thread_local const TaskScheduler* t_scheduler = nullptr;
+thread_local unsigned t_queue = 0;
+
+// Failed steal attempts before an idle worker goes to sleep
+const int IDLE_SPINS = 64;
+
+}  // namespace
+
+unsigned TaskScheduler::max_threads() {
+    return std::max(64u, 8 * std::thread::hardware_concurrency());
+}
+
+TaskScheduler::TaskScheduler(unsigned threads) {
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    threads = std::min(threads, max_threads());
+
+    queues_.reserve(threads);
+    for (unsigned i = 0; i < threads; ++i) {
+        queues_.push_back(std::make_unique<WorkQueue>());
+    }
+    thread_ids_.assign(threads, 0);
+    thread_ids_[0] = current_thread_id();
+    workers_.reserve(threads - 1);
+    for (unsigned i = 1; i < threads; ++i) {
+        workers_.emplace_back(&TaskScheduler::worker_loop, this, i);
+    }
+
+    // Wait until every worker has recorded its thread id
+    while (started_.load(std::memory_order_acquire) < threads - 1) {
+        std::this_thread::yield();
+    }
+}
+
+TaskScheduler::~TaskScheduler() {
+    {
+        std::lock_guard<std::mutex> lock(sleep_mutex_);
+        stopping_.store(true);
+    }
+    wake_.notify_all();
+    for (auto& worker : workers_) {
+        worker.join();
+    }
+}
+
+void TaskScheduler::push(Task task) {
+    unsigned self = (t_scheduler == this) ? t_queue : 0;
+    {
+        std::lock_guard<std::mutex> lock(queues_[self]->mutex);
+        queues_[self]->tasks.push_back(std::move(task));
+    }
+    queued_.fetch_add(1);
+
+    // Taking the sleep lock orders this against a worker that has just
+    // checked `queued_` and is about to wait, so the wakeup is not lost.
+    { std::lock_guard<std::mutex> lock(sleep_mutex_); }
+    wake_.notify_one();
+}
+
+bool TaskScheduler::take(unsigned self, Task& task) {
+    // Own deque first, newest task
+    {
+        WorkQueue& own = *queues_[self];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty()) {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            queued_.fetch_sub(1);
+            return true;
+        }
+    }
+
+    // Then steal the oldest task of the next non-empty deque
+    const size_t count = queues_.size();
+    for (size_t step = 1; step < count; ++step) {
+        WorkQueue& victim = *queues_[(self + step) % count];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            queued_.fetch_sub(1);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool TaskScheduler::run_one() {
+    unsigned self = (t_scheduler == this) ? t_queue : 0;
+    Task task;
+    if (!take(self, task)) {
+        return false;
+    }
+    task.fn();
+    task.group->pending_.fetch_sub(1, std::memory_order_release);
+    return true;
+}
+
+void TaskScheduler::worker_loop(unsigned index) {
+    t_scheduler = this;
+    t_queue = index;
+    thread_ids_[index] = current_thread_id();
+    started_.fetch_add(1, std::memory_order_release);
+
+    int idle = 0;
+    while (!stopping_.load()) {
+        if (run_one()) {
+            idle = 0;
+            continue;
+        }
+        if (++idle < IDLE_SPINS) {
+            std::this_thread::yield();
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(sleep_mutex_);
+        wake_.wait(lock, [this] { return stopping_.load() || queued_.load() > 0; });
+        idle = 0;
+    }
+}
+
+void TaskScheduler::parallel_for(size_t count, size_t grain,
+                                 const std::function<void(size_t, size_t)>& body) {
+    if (count == 0) return;
+    grain = std::max<size_t>(grain, 1);
+    if (workers_.empty() || count <= grain) {
+        for (size_t begin = 0; begin < count; begin += grain) {
+            body(begin, std::min(count, begin + grain));
+        }
+        return;
+    }
+
+    TaskGroup group(*this);
+    std::function<void(size_t, size_t)> split = [&](size_t begin, size_t end) {
+        // Hand off the upper half until what is left fits in one chunk
+        while (end - begin > grain) {
+            size_t mid = begin + (end - begin) / 2;
+            group.run([&split, mid, end] { split(mid, end); });
+            end = mid;
+        }
+        body(begin, end);
+    };
+    split(0, count);
+    group.wait();
+}
+
+void TaskGroup::run(std::function<void()> fn) {
+    if (scheduler_.workers_.empty()) {
+        fn();
+        return;
+    }
+    pending_.fetch_add(1, std::memory_order_relaxed);
+    scheduler_.push({std::move(fn), this});
+}
+
+void TaskGroup::wait() {
+    while (pending_.load(std::memory_order_acquire) > 0) {
+        if (!scheduler_.run_one()) {
+            std::this_thread::yield();
+        }
+    }
+}
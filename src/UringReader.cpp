@@ -0,0 +1,357 @@
+#include "UringReader.h"
+
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+namespace {
+
+const unsigned RING_ENTRIES = 256;
+
+// user_data layout: file index in the upper bits, operation in the low byte
+enum UringOp : uint64_t {
+    OP_OPEN = 1,
+    OP_STATX = 2,
+    OP_READ = 3,
+    OP_CLOSE = 4,
+};
+
+uint64_t make_user_data(size_t index, UringOp op) {
+    return (static_cast<uint64_t>(index) << 8) | op;
+}
+
+// Descriptors opened for one batch. Any still held when the batch is
+// abandoned are closed with it.
+struct BatchFds {
+    std::vector<int> fds;
+
+    explicit BatchFds(size_t count) : fds(count, -1) {}
+    ~BatchFds() {
+        for (int fd : fds) {
+            if (fd >= 0) close(fd);
+        }
+    }
+    BatchFds(const BatchFds&) = delete;
+    BatchFds& operator=(const BatchFds&) = delete;
+};
+
+int sys_io_uring_setup(unsigned entries, io_uring_params* params) {
+    return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+}
+
+int sys_io_uring_enter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags) {
+    return static_cast<int>(syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, nullptr, 0));
+}
+
+int sys_io_uring_register(int fd, unsigned opcode, const void* arg, unsigned nr_args) {
+    return static_cast<int>(syscall(__NR_io_uring_register, fd, opcode, arg, nr_args));
+}
+
+// The rings are shared with the kernel; head/tail are published with
+// release stores and read with acquire loads.
+unsigned load_acquire(const unsigned* p) {
+    return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+}
+
+void store_release(unsigned* p, unsigned value) {
+    __atomic_store_n(p, value, __ATOMIC_RELEASE);
+}
+
+}  // namespace
+
+UringReader::~UringReader() {
+    if (ring_fd_ >= 0) {
+        if (arena_registered_) {
+            sys_io_uring_register(ring_fd_, IORING_UNREGISTER_BUFFERS, nullptr, 0);
+        }
+        close(ring_fd_);
+    }
+    if (sqes_) munmap(sqes_, sqes_size_);
+    if (cq_map_ && cq_map_ != sq_map_) munmap(cq_map_, cq_map_size_);
+    if (sq_map_) munmap(sq_map_, sq_map_size_);
+}
+
+bool UringReader::init() {
+    io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    int fd = sys_io_uring_setup(RING_ENTRIES, &params);
+    if (fd < 0) {
+        return false;  // ENOSYS, or disabled by sysctl/seccomp
+    }
+    ring_fd_ = fd;
+
+    // Every opcode the batches use must be supported (openat/statx/close need 5.6)
+    std::vector<uint8_t> probe_buf(sizeof(io_uring_probe) + 256 * sizeof(io_uring_probe_op), 0);
+    io_uring_probe* probe = reinterpret_cast<io_uring_probe*>(probe_buf.data());
+    if (sys_io_uring_register(ring_fd_, IORING_REGISTER_PROBE, probe, 256) < 0) {
+        return false;
+    }
+    for (unsigned op : {IORING_OP_OPENAT, IORING_OP_STATX, IORING_OP_READ, IORING_OP_READ_FIXED,
+                        IORING_OP_CLOSE}) {
+        if (op > probe->last_op || !(probe->ops[op].flags & IO_URING_OP_SUPPORTED)) {
+            return false;
+        }
+    }
+
+    sq_map_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    cq_map_size_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    const bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (single_mmap) {
+        sq_map_size_ = cq_map_size_ = std::max(sq_map_size_, cq_map_size_);
+    }
+
+    sq_map_ = mmap(nullptr, sq_map_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                   ring_fd_, IORING_OFF_SQ_RING);
+    if (sq_map_ == MAP_FAILED) {
+        sq_map_ = nullptr;
+        return false;
+    }
+    if (single_mmap) {
+        cq_map_ = sq_map_;
+    } else {
+        cq_map_ = mmap(nullptr, cq_map_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                       ring_fd_, IORING_OFF_CQ_RING);
+        if (cq_map_ == MAP_FAILED) {
+            cq_map_ = nullptr;
+            return false;
+        }
+    }
+    sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+    void* sqes = mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                      ring_fd_, IORING_OFF_SQES);
+    if (sqes == MAP_FAILED) {
+        return false;
+    }
+    sqes_ = static_cast<io_uring_sqe*>(sqes);
+
+    uint8_t* sq = static_cast<uint8_t*>(sq_map_);
+    sq_head_ = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+    sq_tail_ = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+    sq_mask_ = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+    sq_array_ = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+
+    uint8_t* cq = static_cast<uint8_t*>(cq_map_);
+    cq_head_ = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+    cq_tail_ = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+    cq_mask_ = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+    cqes_ = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+
+    // Each phase queues at most one operation per file
+    batch_capacity_ = std::min(params.sq_entries, params.cq_entries);
+    return batch_capacity_ > 0;
+}
+
+io_uring_sqe* UringReader::next_sqe() {
+    unsigned tail = *sq_tail_;
+    unsigned index = tail & sq_mask_;
+    io_uring_sqe* sqe = &sqes_[index];
+    memset(sqe, 0, sizeof(*sqe));
+    sq_array_[index] = index;
+    store_release(sq_tail_, tail + 1);
+    ++pending_submit_;
+    return sqe;
+}
+
+bool UringReader::submit_and_wait(unsigned count, std::vector<Completion>& completions) {
+    completions.clear();
+    while (completions.size() < count) {
+        unsigned want = static_cast<unsigned>(count - completions.size());
+        int ret = sys_io_uring_enter(ring_fd_, pending_submit_, want, IORING_ENTER_GETEVENTS);
+        if (ret < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        pending_submit_ -= std::min<unsigned>(pending_submit_, static_cast<unsigned>(ret));
+
+        unsigned head = *cq_head_;
+        const unsigned tail = load_acquire(cq_tail_);
+        for (; head != tail; ++head) {
+            const io_uring_cqe& cqe = cqes_[head & cq_mask_];
+            completions.push_back({cqe.user_data, cqe.res});
+        }
+        store_release(cq_head_, head);
+    }
+    return true;
+}
+
+// Takes back the entries queued since the last successful submit. The
+// kernel consumes entries in ring order and has not seen these, so they
+// must not go out with a later call. Returns how many were withdrawn.
+unsigned UringReader::withdraw_unsubmitted() {
+    unsigned withdrawn = pending_submit_;
+    store_release(sq_tail_, *sq_tail_ - withdrawn);
+    pending_submit_ = 0;
+    return withdrawn;
+}
+
+bool UringReader::ensure_arena(size_t size) {
+    if (size <= arena_size_) return true;
+
+    if (arena_registered_) {
+        sys_io_uring_register(ring_fd_, IORING_UNREGISTER_BUFFERS, nullptr, 0);
+        arena_registered_ = false;
+    }
+    // Grow geometrically so a run of similar batches registers only once
+    arena_size_ = std::min(std::max(size, arena_size_ * 2), MAX_ARENA_SIZE);
+    arena_.reset(new uint8_t[arena_size_]);
+
+    if (can_register_) {
+        iovec iov{arena_.get(), arena_size_};
+        if (sys_io_uring_register(ring_fd_, IORING_REGISTER_BUFFERS, &iov, 1) == 0) {
+            arena_registered_ = true;
+        } else {
+            can_register_ = false;  // Likely RLIMIT_MEMLOCK; plain reads from now on
+        }
+    }
+    return true;
+}
+
+bool UringReader::read_batch(const std::vector<const std::string*>& paths,
+                             std::vector<FileData>& results) {
+    const size_t count = paths.size();
+    results.assign(count, FileData());
+    BatchFds batch_fds(count);
+    std::vector<int>& fds = batch_fds.fds;
+    std::vector<struct statx> stats(count);
+    std::vector<Completion> completions;
+
+    // Phase 1: open everything. Completions that arrived before a failure
+    // still hand over their descriptors, so they get closed.
+    for (size_t i = 0; i < count; ++i) {
+        io_uring_sqe* sqe = next_sqe();
+        sqe->opcode = IORING_OP_OPENAT;
+        sqe->fd = AT_FDCWD;
+        sqe->addr = reinterpret_cast<uint64_t>(paths[i]->c_str());
+        sqe->open_flags = O_RDONLY | O_CLOEXEC;
+        sqe->user_data = make_user_data(i, OP_OPEN);
+    }
+    bool ring_ok = submit_and_wait(static_cast<unsigned>(count), completions);
+    for (const auto& c : completions) {
+        size_t i = c.user_data >> 8;
+        if (c.res >= 0) {
+            fds[i] = c.res;
+        } else {
+            results[i].error = -c.res;
+            results[i].open_failed = true;
+        }
+    }
+    if (!ring_ok) {
+        withdraw_unsubmitted();
+        return false;
+    }
+
+    // Phase 2: stat what was opened, through the descriptor
+    static const char EMPTY_PATH[] = "";
+    unsigned stats_queued = 0;
+    for (size_t i = 0; i < count; ++i) {
+        if (fds[i] < 0) continue;
+        io_uring_sqe* sqe = next_sqe();
+        sqe->opcode = IORING_OP_STATX;
+        sqe->fd = fds[i];
+        sqe->addr = reinterpret_cast<uint64_t>(EMPTY_PATH);
+        sqe->statx_flags = AT_EMPTY_PATH;
+        sqe->len = STATX_TYPE | STATX_SIZE;
+        sqe->off = reinterpret_cast<uint64_t>(&stats[i]);
+        sqe->user_data = make_user_data(i, OP_STATX);
+        ++stats_queued;
+    }
+    if (stats_queued > 0 && !submit_and_wait(stats_queued, completions)) {
+        withdraw_unsubmitted();
+        return false;
+    }
+    for (const auto& c : completions) {
+        size_t i = c.user_data >> 8;
+        if (c.res < 0) results[i].error = -c.res;
+    }
+
+    // Phase 3: read every regular file that fits into its slice of the arena
+    std::vector<size_t> offsets(count, 0);
+    size_t total = 0;
+    for (size_t i = 0; i < count; ++i) {
+        if (fds[i] < 0 || results[i].error) continue;
+        size_t slice = (static_cast<size_t>(stats[i].stx_size) + 63) & ~size_t{63};
+        if (!S_ISREG(stats[i].stx_mode) || slice > MAX_ARENA_SIZE - total) {
+            results[i].in_arena = false;
+            continue;
+        }
+        offsets[i] = total;
+        results[i].size = static_cast<size_t>(stats[i].stx_size);
+        total += slice;
+    }
+    ensure_arena(total);
+
+    std::vector<size_t> done(count, 0);
+    while (true) {
+        unsigned queued = 0;
+        for (size_t i = 0; i < count; ++i) {
+            if (fds[i] < 0 || results[i].error || !results[i].in_arena || done[i] >= results[i].size) {
+                continue;
+            }
+            io_uring_sqe* sqe = next_sqe();
+            sqe->opcode = arena_registered_ ? IORING_OP_READ_FIXED : IORING_OP_READ;
+            sqe->fd = fds[i];
+            sqe->addr = reinterpret_cast<uint64_t>(arena_.get() + offsets[i] + done[i]);
+            sqe->len = static_cast<uint32_t>(std::min<size_t>(results[i].size - done[i], 1u << 30));
+            sqe->off = done[i];
+            sqe->buf_index = 0;
+            sqe->user_data = make_user_data(i, OP_READ);
+            // Ring space: at most batch_capacity() reads are ever in flight
+            ++queued;
+        }
+        if (queued == 0) break;
+        if (!submit_and_wait(queued, completions)) {
+            withdraw_unsubmitted();
+            return false;
+        }
+        for (const auto& c : completions) {
+            size_t i = c.user_data >> 8;
+            if (c.res < 0) {
+                results[i].error = -c.res;
+            } else if (c.res == 0) {
+                results[i].size = done[i];  // File shrank since statx
+            } else {
+                done[i] += static_cast<size_t>(c.res);  // Short reads loop around
+            }
+        }
+    }
+
+    // Phase 4: close. A descriptor whose CLOSE the kernel has taken is no
+    // longer ours, even if the ring then fails; the rest are closed here.
+    std::vector<size_t> closing;
+    for (size_t i = 0; i < count; ++i) {
+        if (fds[i] < 0) continue;
+        if (!results[i].in_arena) {
+            results[i].fd = fds[i];
+            fds[i] = -1;
+            continue;
+        }
+        io_uring_sqe* sqe = next_sqe();
+        sqe->opcode = IORING_OP_CLOSE;
+        sqe->fd = fds[i];
+        sqe->user_data = make_user_data(i, OP_CLOSE);
+        closing.push_back(i);
+    }
+    if (!closing.empty() && !submit_and_wait(static_cast<unsigned>(closing.size()), completions)) {
+        size_t taken = closing.size() - withdraw_unsubmitted();
+        for (size_t k = 0; k < taken; ++k) {
+            fds[closing[k]] = -1;
+        }
+        return false;
+    }
+    std::fill(fds.begin(), fds.end(), -1);
+
+    for (size_t i = 0; i < count; ++i) {
+        if (!results[i].error && results[i].in_arena) {
+            results[i].data = arena_.get() + offsets[i];
+        }
+    }
+    return true;
+}
@@ -1,21 +1,275 @@
+#include <cstdint>
 #include <iostream>
 #include <string>
 #include <vector>
 
+#include "ImageHandoff.h"
 #include "Linker.h"
+#include "ObjectDump.h"
+#include "TaskScheduler.h"
+
+namespace {
+
+void print_usage() {
+    std::cout << "Usage: mllinker <output.bin> [options] <input1.obj|lib> [input2 ...]" << std::endl;
+    std::cout << "       mllinker <name> --output-memfd [options] <inputs> -- <command> [args]" << std::endl;
+    std::cout << "       mllinker --dump [dump options] <file.obj|dir> ..." << std::endl;
+    std::cout << "Options:" << std::endl;
+    std::cout << "  -L <dir>     Add <dir> to the library search path" << std::endl;
+    std::cout << "  -l <name>    Link lib<name>.obj, <name>.obj or lib<name>.lib from the search path"
+              << std::endl;
+    std::cout << "  -T <file>    Read memory regions and section placement from <file>" << std::endl;
+    std::cout << "  --align-functions=<N>  Align the start of every object's text to N bytes" << std::endl;
+    std::cout << "  --text-fill=<W>  Fill text alignment gaps with instruction word W (default: 0)"
+              << std::endl;
+    std::cout << "  --relax      Delete branches to the next instruction in relaxable objects" << std::endl;
+    std::cout << "  --wrap=<sym> Send references to <sym> to __wrap_<sym>; __real_<sym> reaches the original"
+              << std::endl;
+    std::cout << "  --export-table=<file>  Emit a perfect-hash name->address table (__export_table)"
+              << std::endl;
+    std::cout << "                         for the symbols listed in <file>" << std::endl;
+    std::cout << "  --compress   Write the image as independently LZ4-compressed 64 KiB blocks" << std::endl;
+    std::cout << "  --build-id   Store a SHA-256 tree hash of the image at __build_id" << std::endl;
+    std::cout << "  --threads=<N>  Use N threads for loading, layout, relocation, hashing and compression"
+              << std::endl;
+    std::cout << "                 (default: one per CPU; output does not depend on N)" << std::endl;
+    std::cout << "  --no-io-uring  Read inputs with one mmap/read per file instead of io_uring batches"
+              << std::endl;
+    std::cout << "  --stats=<file>   Write per-phase wall-clock times to <file> as JSON" << std::endl;
+    std::cout << "  --perf-counters  Add per-thread cycles, instructions, cache and branch misses"
+              << std::endl;
+    std::cout << "                   to the --stats phases (via perf_event_open)" << std::endl;
+    std::cout << "  --size-report=<file>  Write bytes per object and symbol, and why each object" << std::endl;
+    std::cout << "                        was linked, to <file> as JSON" << std::endl;
+    std::cout << "  --shared=<file>  Link every input as a shared image at its -T address and"
+              << std::endl;
+    std::cout << "                   write its exported symbols to <file>" << std::endl;
+    std::cout << "  --link-shared=<file>  Resolve symbols against a shared image's exports"
+              << std::endl;
+    std::cout << "                        instead of linking its code (may be repeated)" << std::endl;
+    std::cout << "  --output-fd=<N>  Write the image to inherited descriptor N instead of <output.bin>"
+              << std::endl;
+    std::cout << "  --output-memfd   Link into a sealed memfd and exec the command after --, which"
+              << std::endl;
+    std::cout << "                   inherits it (its number replaces {fd} and is in MLLINKER_IMAGE_FD)"
+              << std::endl;
+    std::cout << "Dump options:" << std::endl;
+    std::cout << "  --json        Print one JSON document instead of text" << std::endl;
+    std::cout << "  --summary     Print section sizes and symbol/relocation counts, one line per object"
+              << std::endl;
+    std::cout << "  --duplicates  Report symbols defined in more than one object" << std::endl;
+    std::cout << "  --width=<N>   Bytes per hexdump line (default: 16)" << std::endl;
+    std::cout << "  --threads=<N>, --no-io-uring  As for linking" << std::endl;
+}
+
+// Reads the value of a short option given either as "-Xvalue" or "-X value".
+bool take_short_value(int argc, char* argv[], int& i, std::string& value) {
+    std::string arg = argv[i];
+    if (arg.size() > 2) {
+        value = arg.substr(2);
+        return true;
+    }
+    if (i + 1 >= argc) {
+        std::cerr << "Error: Option " << arg << " requires an argument" << std::endl;
+        return false;
+    }
+    value = argv[++i];
+    return true;
+}
+
+// Matches "--name=value" and returns the value part.
+bool match_long_value(const std::string& arg, const std::string& name, std::string& value) {
+    std::string prefix = name + "=";
+    if (arg.rfind(prefix, 0) != 0) return false;
+    value = arg.substr(prefix.size());
+    return true;
+}
+
+bool parse_uint32(const std::string& option, const std::string& text, uint32_t& value) {
+    try {
+        size_t consumed = 0;
+        unsigned long parsed = std::stoul(text, &consumed, 0);
+        if (consumed == text.size() && parsed <= UINT32_MAX) {
+            value = static_cast<uint32_t>(parsed);
+            return true;
+        }
+    } catch (const std::exception&) {
+    }
+    std::cerr << "Error: Invalid value '" << text << "' for " << option << std::endl;
+    return false;
+}
+
+// --threads: 0 means one per CPU; more than the scheduler would run is refused
+bool parse_threads(const std::string& text, unsigned& threads) {
+    uint32_t value = 0;
+    if (!parse_uint32("--threads", text, value)) return false;
+    if (value > TaskScheduler::max_threads()) {
+        std::cerr << "Error: --threads must be at most " << TaskScheduler::max_threads()
+                  << std::endl;
+        return false;
+    }
+    threads = value;
+    return true;
+}
+
+int dump_main(int argc, char* argv[]) {
+    DumpOptions options;
+    for (int i = 2; i < argc; ++i) {
+        std::string arg = argv[i];
+        std::string value;
+
+        if (arg == "--json") {
+            options.json = true;
+        } else if (arg == "--summary") {
+            options.summary = true;
+        } else if (arg == "--duplicates") {
+            options.duplicates = true;
+        } else if (arg == "--no-io-uring") {
+            options.io_uring = false;
+        } else if (match_long_value(arg, "--threads", value)) {
+            if (!parse_threads(value, options.threads)) return 1;
+        } else if (match_long_value(arg, "--width", value)) {
+            uint32_t width = 0;
+            if (!parse_uint32("--width", value, width)) return 1;
+            if (width == 0) {
+                std::cerr << "Error: --width must be at least 1" << std::endl;
+                return 1;
+            }
+            options.width = width;
+        } else if (arg.size() > 1 && arg[0] == '-') {
+            std::cerr << "Error: Unknown dump option " << arg << std::endl;
+            print_usage();
+            return 1;
+        } else {
+            options.paths.push_back(arg);
+        }
+    }
+
+    if (options.paths.empty()) {
+        print_usage();
+        return 1;
+    }
+    return dump_objects(options) ? 0 : 1;
+}
+
+}  // namespace
 
 int main(int argc, char* argv[]) {
+    if (argc >= 2 && std::string(argv[1]) == "--dump") {
+        return dump_main(argc, argv);
+    }
     if (argc < 3) {
-        std::cout << "Usage: mllinker <output.bin> <input1.obj> [input2.obj ...]" << std::endl;
+        print_usage();
         return 1;
     }
 
-    std::string output_path = argv[1];
-    std::vector<std::string> input_files(argv + 2, argv + argc);
+    LinkOptions options;
+    options.output_path = argv[1];
+    bool output_memfd = false;
+    std::vector<std::string> command;  // After "--", run by --output-memfd
 
-    if (!link_objects(input_files, output_path)) {
+    for (int i = 2; i < argc; ++i) {
+        std::string arg = argv[i];
+        std::string value;
+
+        if (arg == "--") {
+            command.assign(argv + i + 1, argv + argc);
+            break;
+        } else if (arg == "--relax") {
+            options.relax = true;
+        } else if (arg == "--compress") {
+            options.compress = true;
+        } else if (arg == "--build-id") {
+            options.build_id = true;
+        } else if (arg == "--no-io-uring") {
+            options.io_uring = false;
+        } else if (arg == "--perf-counters") {
+            options.perf_counters = true;
+        } else if (arg == "--output-memfd") {
+            output_memfd = true;
+        } else if (match_long_value(arg, "--output-fd", value)) {
+            uint32_t fd = 0;
+            if (!parse_uint32("--output-fd", value, fd)) return 1;
+            if (fd > INT32_MAX) {
+                std::cerr << "Error: Invalid value '" << value << "' for --output-fd" << std::endl;
+                return 1;
+            }
+            options.output_fd = static_cast<int>(fd);
+        } else if (match_long_value(arg, "--stats", value)) {
+            options.stats_path = value;
+        } else if (match_long_value(arg, "--size-report", value)) {
+            options.size_report_path = value;
+        } else if (match_long_value(arg, "--shared", value)) {
+            options.shared_symbols_path = value;
+        } else if (match_long_value(arg, "--link-shared", value)) {
+            options.link_shared.push_back(value);
+        } else if (match_long_value(arg, "--export-table", value)) {
+            options.export_table_path = value;
+        } else if (match_long_value(arg, "--wrap", value)) {
+            options.wrap_symbols.push_back(value);
+        } else if (match_long_value(arg, "--threads", value)) {
+            if (!parse_threads(value, options.threads)) return 1;
+        } else if (match_long_value(arg, "--align-functions", value)) {
+            if (!parse_uint32("--align-functions", value, options.align_functions)) return 1;
+            if ((options.align_functions & (options.align_functions - 1)) != 0) {
+                std::cerr << "Error: --align-functions must be a power of two" << std::endl;
+                return 1;
+            }
+        } else if (match_long_value(arg, "--text-fill", value)) {
+            if (!parse_uint32("--text-fill", value, options.text_fill)) return 1;
+        } else if (arg.rfind("-L", 0) == 0) {
+            if (!take_short_value(argc, argv, i, value)) return 1;
+            options.library_paths.push_back(value);
+        } else if (arg.rfind("-l", 0) == 0) {
+            if (!take_short_value(argc, argv, i, value)) return 1;
+            options.inputs.push_back({value, true});
+        } else if (arg.rfind("-T", 0) == 0) {
+            if (!take_short_value(argc, argv, i, value)) return 1;
+            options.memory_layout_path = value;
+        } else if (arg.size() > 1 && arg[0] == '-') {
+            std::cerr << "Error: Unknown option " << arg << std::endl;
+            print_usage();
+            return 1;
+        } else {
+            options.inputs.push_back({arg, false});
+        }
+    }
+
+    if (options.inputs.empty()) {
+        print_usage();
+        return 1;
+    }
+    if (options.perf_counters && options.stats_path.empty()) {
+        std::cerr << "Error: --perf-counters requires --stats=<file>" << std::endl;
+        return 1;
+    }
+
+    if (output_memfd && options.output_fd >= 0) {
+        std::cerr << "Error: --output-memfd and --output-fd cannot be combined" << std::endl;
+        return 1;
+    }
+    if (output_memfd != !command.empty()) {
+        std::cerr << "Error: --output-memfd needs a command after --, and -- is only for --output-memfd"
+                  << std::endl;
+        return 1;
+    }
+    if ((output_memfd || options.output_fd >= 0) && !options.shared_symbols_path.empty()) {
+        std::cerr << "Error: --shared needs an output file that programs can refer to" << std::endl;
         return 1;
     }
 
+    int image_fd = -1;
+    if (output_memfd) {
+        if (!create_image_memfd(options.output_path, image_fd)) return 1;
+        options.output_fd = image_fd;
+    }
+
+    if (!link_objects(options)) {
+        return 1;
+    }
+    if (output_memfd) {
+        return exec_with_image(image_fd, command) ? 0 : 1;
+    }
+
     return 0;
-}
\ No newline at end of file
+}
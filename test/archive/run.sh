@@ -0,0 +1,16 @@
+# A .lib archive is read through its index: rt_init is fetched for main,
+# and rt_alloc for rt_init. The member defining rt_unused is not linked, so
+# its reference to an undefined name is no error. An object before the archive that
+# already defines rt_alloc keeps its member out.
+for name in main init alloc unused myalloc; do $GEN $CASE/$name.json $name.obj >/dev/null; done
+mkdir lib
+$LIBGEN lib/librt.lib init.obj unused.obj alloc.obj >/dev/null
+
+echo "== lazy members"
+$LINKER out.bin --size-report=size.json main.obj -L lib -lrt; echo "exit $?"
+od -A x -t x1 out.bin
+grep -E '"file"|"activated_by"' size.json
+
+echo "== earlier definition"
+$LINKER own.bin main.obj myalloc.obj lib/librt.lib; echo "exit $?"
+od -A x -t x1 own.bin
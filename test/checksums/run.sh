@@ -0,0 +1,40 @@
+# Objects with per-part CRC32C checksums, plain and compressed, link to the
+# same image as objects without. A flipped byte in any part is reported
+# before the object is used.
+for name in main helper; do
+    $GEN $CASE/$name.json $name.obj >/dev/null
+    $GEN --checksum $CASE/$name.json k$name.obj >/dev/null
+    $GEN --compress --checksum $CASE/$name.json ck$name.obj >/dev/null
+done
+
+echo "== checksummed"
+$LINKER plain.bin main.obj helper.obj; echo "exit $?"
+$LINKER sum.bin kmain.obj khelper.obj; echo "exit $?"
+cmp plain.bin sum.bin && echo "same image"
+$LINKER csum.bin ckmain.obj ckhelper.obj; echo "exit $?"
+cmp plain.bin csum.bin && echo "same image"
+
+# Flips the byte at offset $2 of file $1
+flip() {
+    python3 -c "import sys; p, o = sys.argv[1], int(sys.argv[2]); b = bytearray(open(p, 'rb').read()); b[o] ^= 0xFF; open(p, 'wb').write(b)" "$1" "$2"
+}
+
+echo "== corrupt text"
+cp khelper.obj bad_text.obj
+flip bad_text.obj 80
+$LINKER bad.bin kmain.obj bad_text.obj; echo "exit $?"
+
+echo "== corrupt symbol table"
+cp khelper.obj bad_sym.obj
+flip bad_sym.obj 100
+$LINKER bad.bin kmain.obj bad_sym.obj; echo "exit $?"
+
+echo "== corrupt compressed text"
+cp ckhelper.obj bad_ctext.obj
+flip bad_ctext.obj 86
+$LINKER bad.bin ckmain.obj bad_ctext.obj; echo "exit $?"
+
+echo "== same corruption without checksums"
+cp helper.obj unchecked.obj
+flip unchecked.obj 80
+$LINKER unchecked.bin main.obj unchecked.obj; echo "exit $?"
@@ -0,0 +1,22 @@
+# LZ4-compressed objects link to the same image as plain ones, alone or
+# mixed with plain objects. A compressed object cut short is rejected.
+for name in main helper; do
+    $GEN $CASE/$name.json $name.obj >/dev/null
+    $GEN --compress $CASE/$name.json c$name.obj >/dev/null
+done
+
+echo "== plain"
+$LINKER plain.bin main.obj helper.obj; echo "exit $?"
+od -A x -t x1 plain.bin
+
+echo "== compressed"
+$LINKER comp.bin cmain.obj chelper.obj; echo "exit $?"
+cmp plain.bin comp.bin && echo "same image"
+
+echo "== mixed"
+$LINKER mixed.bin cmain.obj helper.obj; echo "exit $?"
+cmp plain.bin mixed.bin && echo "same image"
+
+echo "== truncated"
+head -c 100 chelper.obj > cut.obj
+$LINKER cut.bin cmain.obj cut.obj; echo "exit $?"
@@ -0,0 +1,19 @@
+# An input named twice, under any spelling of its path, and a byte-identical
+# copy from another directory are each linked once. A copy that differs in
+# any byte (here a compressed build) is a separate input, so its symbols
+# collide.
+$GEN $CASE/main.json main.obj >/dev/null
+$GEN $CASE/util.json util.obj >/dev/null
+mkdir -p build/a build/b
+cp util.obj build/a/util.obj
+cp util.obj build/b/util.obj
+$GEN --compress $CASE/util.json build/b/util_z.obj >/dev/null
+
+echo "== folded"
+$LINKER out.bin --stats=stats.json main.obj util.obj ./util.obj build/../util.obj \
+    build/a/util.obj build/b/util.obj; echo "exit $?"
+od -A x -t x1 out.bin
+grep -o '"folded_inputs": *[0-9]*' stats.json
+
+echo "== different bytes"
+$LINKER bad.bin main.obj util.obj build/b/util_z.obj; echo "exit $?"
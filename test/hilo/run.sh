@@ -0,0 +1,14 @@
+# HI16/LO16 pairs: the high half is rounded up when the low half's bit 15 is
+# set (LO16 is sign-extended when added), and a HI16 whose LO16 is not in the
+# next instruction is an error
+cp $CASE/*.ld .
+$GEN $CASE/main.json main.obj >/dev/null
+$GEN $CASE/unpaired.json unpaired.obj >/dev/null
+$GEN $CASE/data.json data.obj >/dev/null
+
+echo "== pairs"
+$LINKER out.bin -T high.ld main.obj data.obj; echo "exit $?"
+od -A x -t x1 -N 16 out.bin
+
+echo "== unpaired"
+$LINKER bad.bin unpaired.obj data.obj; echo "exit $?"
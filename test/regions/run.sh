@@ -0,0 +1,20 @@
+# -T placement: a symbol placed through the fast region, a distant region
+# written as a segmented image, and the errors for overflow and a missing
+# fast region
+cp $CASE/*.ld .
+$GEN $CASE/main.json main.obj >/dev/null
+$GEN $CASE/hot.json hot.obj >/dev/null
+
+echo "== near"
+$LINKER near.bin -T near.ld main.obj hot.obj; echo "exit $?"
+od -A x -t x1 near.bin
+
+echo "== far"
+$LINKER far.bin -T far.ld main.obj hot.obj; echo "exit $?"
+od -A x -t x1 far.bin
+
+echo "== overflow"
+$LINKER small.bin -T small.ld main.obj hot.obj; echo "exit $?"
+
+echo "== no fast region"
+$LINKER nofast.bin -T nofast.ld main.obj hot.obj; echo "exit $?"
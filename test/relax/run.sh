@@ -0,0 +1,13 @@
+# --relax deletes each BRANCH26 to the next instruction in a relaxable
+# object. Later symbols move down, and the symbol holding each deleted word
+# shrinks by 4 bytes in the size report.
+$GEN $CASE/main.json main.obj >/dev/null
+
+echo "== without --relax"
+$LINKER plain.bin main.obj; echo "exit $?"
+od -A x -t x1 plain.bin
+
+echo "== --relax"
+$LINKER relaxed.bin --relax --size-report=size.json main.obj; echo "exit $?"
+od -A x -t x1 relaxed.bin
+cat size.json
@@ -0,0 +1,81 @@
+#!/usr/bin/env python3
+"""
+Runs the linker regression cases. Each directory under test/ with a run.sh is
+one case: its JSON fixtures are turned into objects with tools/obj_gen.py by
+the script itself, which then links them and dumps what it wants compared.
+The combined stdout and stderr must match the case's `expected` file.
+
+    python3 test/run_tests.py [--linker ./mllinker] [--update] [case ...]
+
+Scripts run in a scratch directory with these variables set:
+    CASE    the case directory (fixtures live here)
+    LINKER  the linker binary
+    GEN     obj_gen.py, as "python3 .../obj_gen.py"
+    LIBGEN  lib_gen.py, likewise
+    TOOLS   the tools/ directory
+"""
+import argparse
+import os
+import subprocess
+import sys
+import tempfile
+from pathlib import Path
+
+ROOT = Path(__file__).resolve().parent.parent
+
+
+def run_case(case: Path, linker: Path) -> str:
+    tools = ROOT / "tools"
+    env = dict(os.environ,
+               CASE=str(case),
+               LINKER=str(linker),
+               GEN=f"python3 {tools / 'obj_gen.py'}",
+               LIBGEN=f"python3 {tools / 'lib_gen.py'}",
+               TOOLS=str(tools))
+    with tempfile.TemporaryDirectory() as scratch:
+        result = subprocess.run(["sh", str(case / "run.sh")], cwd=scratch, env=env,
+                                stdout=subprocess.PIPE, stderr=subprocess.STDOUT, text=True)
+    return result.stdout
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n\n")[0])
+    parser.add_argument("--linker", type=Path, default=ROOT / "mllinker")
+    parser.add_argument("--update", action="store_true",
+                        help="rewrite each case's expected output instead of comparing")
+    parser.add_argument("cases", nargs="*", help="case names (default: all)")
+    args = parser.parse_args()
+
+    linker = args.linker.resolve()
+    if not linker.is_file():
+        sys.exit(f"error: linker {linker} not found (run make first)")
+
+    here = Path(__file__).resolve().parent
+    cases = [here / name for name in args.cases] if args.cases else \
+        sorted(path.parent for path in here.glob("*/run.sh"))
+
+    failed = 0
+    for case in cases:
+        output = run_case(case, linker)
+        expected_path = case / "expected"
+        if args.update:
+            expected_path.write_text(output)
+            print(f"updated {case.name}")
+            continue
+        expected = expected_path.read_text() if expected_path.exists() else None
+        if output == expected:
+            print(f"PASS {case.name}")
+        else:
+            failed += 1
+            print(f"FAIL {case.name}")
+            if expected is None:
+                print("  (no expected file)")
+            for line in output.splitlines():
+                print(f"  | {line}")
+
+    print(f"{len(cases) - failed} passed, {failed} failed")
+    return 1 if failed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,13 @@
+# SDA16 displacements from __sdata_base (start of .sdata + 0x8000), and the
+# error for a target outside the signed 16-bit reach of the base
+cp $CASE/*.ld .
+$GEN $CASE/main.json main.obj >/dev/null
+$GEN $CASE/small.json small.obj >/dev/null
+$GEN $CASE/far.json far.obj >/dev/null
+
+echo "== in range"
+$LINKER out.bin main.obj small.obj; echo "exit $?"
+od -A x -t x1 out.bin
+
+echo "== out of range"
+$LINKER bad.bin -T far.ld main.obj far.obj; echo "exit $?"
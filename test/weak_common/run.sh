@@ -0,0 +1,15 @@
+# Precedence strong > COMMON > weak, whatever the link-line order: the strong
+# handler after the weak one wins, COMMON counter overrides the weak one and
+# goes to BSS, the COMMON buf declarations merge to the largest size and
+# strictest alignment, and hook keeps its weak definition. Two strong
+# definitions are still a duplicate.
+for name in main defaults strong strong2 tent1 tent2; do $GEN $CASE/$name.json $name.obj >/dev/null; done
+
+echo "== precedence"
+$LINKER out.bin --size-report=size.json main.obj defaults.obj strong.obj tent1.obj tent2.obj
+echo "exit $?"
+od -A x -t x1 out.bin
+grep '"name"' size.json
+
+echo "== duplicate strong"
+$LINKER dup.bin main.obj defaults.obj strong.obj strong2.obj tent1.obj tent2.obj; echo "exit $?"
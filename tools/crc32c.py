@@ -0,0 +1,26 @@
+"""
+CRC32C (Castagnoli) as used by the object format's per-part checksums.
+Matches src/Checksum.cpp: crc32c(b"123456789") == 0xE3069283.
+"""
+
+_POLY = 0x82F63B78
+
+
+def _make_table():
+    table = []
+    for i in range(256):
+        crc = i
+        for _ in range(8):
+            crc = (crc >> 1) ^ (_POLY if crc & 1 else 0)
+        table.append(crc)
+    return table
+
+
+_TABLE = _make_table()
+
+
+def crc32c(data: bytes) -> int:
+    crc = 0xFFFFFFFF
+    for b in data:
+        crc = _TABLE[(crc ^ b) & 0xFF] ^ (crc >> 8)
+    return crc ^ 0xFFFFFFFF
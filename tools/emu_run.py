@@ -0,0 +1,107 @@
+#!/usr/bin/env python3
+"""
+Stand-in for MyEmulator's image intake when the image never touches the
+filesystem. It takes the image from an inherited descriptor, maps it at its
+base (expanding `--compress` images), and reports what it would run.
+
+  # The linker creates a sealed memfd and execs this with it
+  ./mllinker prog.bin --output-memfd main.obj -- python3 tools/emu_run.py --image-fd {fd}
+
+  # This creates the memfd and runs the linker with --output-fd
+  python3 tools/emu_run.py --link -- prog.bin main.obj
+"""
+import argparse
+import fcntl
+import hashlib
+import os
+import struct
+import subprocess
+import sys
+from pathlib import Path
+
+from img_unpack import MAGIC as COMPRESSED_MAGIC, segments, unpack
+
+
+def read_fd(fd: int) -> bytes:
+    """Whole contents of a memfd/file from offset 0, or of a pipe until EOF."""
+    try:
+        os.lseek(fd, 0, os.SEEK_SET)
+    except OSError:
+        pass  # Not seekable: a pipe is read as it comes
+    chunks = []
+    while True:
+        chunk = os.read(fd, 1 << 20)
+        if not chunk:
+            return b"".join(chunks)
+        chunks.append(chunk)
+
+
+def seals(fd: int) -> str:
+    try:
+        value = fcntl.fcntl(fd, fcntl.F_GET_SEALS)
+    except (AttributeError, OSError):
+        return "none"
+    names = [("seal", 0x1), ("shrink", 0x2), ("grow", 0x4), ("write", 0x8)]
+    return ",".join(name for name, bit in names if value & bit) or "none"
+
+
+def link_into_memfd(linker: str, link_args) -> int:
+    """Runs the linker with --output-fd on a fresh memfd and returns the fd."""
+    fd = os.memfd_create("emu-image", 0)
+    result = subprocess.run([linker, *link_args, f"--output-fd={fd}"], pass_fds=(fd,))
+    if result.returncode != 0:
+        raise RuntimeError(f"linker exited with status {result.returncode}")
+    return fd
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Emulator stand-in fed through a descriptor")
+    parser.add_argument("--image-fd", type=int,
+                        help="descriptor holding the image (default: $MLLINKER_IMAGE_FD)")
+    parser.add_argument("--link", action="store_true",
+                        help="run the linker on the arguments after -- with a fresh memfd")
+    parser.add_argument("--linker", default="./mllinker", help="linker for --link (default: ./mllinker)")
+    parser.add_argument("--base", type=lambda v: int(v, 0), default=0,
+                        help="load address of a flat image (default: 0)")
+    parser.add_argument("-o", "--output", type=Path, help="also write the flat memory image here")
+    parser.add_argument("link_args", nargs=argparse.REMAINDER, help="-- <output> <inputs...>")
+    args = parser.parse_args()
+    link_args = args.link_args[1:] if args.link_args[:1] == ["--"] else args.link_args
+
+    try:
+        if args.link:
+            fd = link_into_memfd(args.linker, link_args)
+        elif args.image_fd is not None:
+            fd = args.image_fd
+        elif "MLLINKER_IMAGE_FD" in os.environ:
+            fd = int(os.environ["MLLINKER_IMAGE_FD"])
+        else:
+            parser.error("no image: give --image-fd, --link or set MLLINKER_IMAGE_FD")
+
+        blob = read_fd(fd)
+        base, image = args.base, blob
+        if len(blob) >= 4 and struct.unpack_from("<I", blob, 0)[0] == COMPRESSED_MAGIC:
+            base, image = unpack(blob)
+        mapped = segments(base, image)
+    except (OSError, ValueError, RuntimeError, struct.error) as e:
+        print(f"Error: {e}", file=sys.stderr)
+        return 1
+
+    print(f"Image fd {fd}: {len(blob)} bytes, seals: {seals(fd)}")
+    for address, data in mapped:
+        print(f"Mapped 0x{address:08X}-0x{address + len(data):08X} ({len(data)} bytes)")
+    print(f"SHA-256 {hashlib.sha256(image).hexdigest()}")
+    if args.output:
+        # Flat memory image from the lowest segment; gaps are seeked over so
+        # they stay sparse
+        low = mapped[0][0]
+        with args.output.open("wb") as out:
+            for address, data in mapped:
+                out.seek(address - low)
+                out.write(data)
+            out.truncate(max(address + len(data) for address, data in mapped) - low)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,83 @@
+#!/usr/bin/env python3
+"""
+Expand a block-compressed image written by `mllinker --compress` back into
+the image file the linker would have written without it (a flat memory image
+or a segmented image), as an emulator loader would.
+"""
+import argparse
+import struct
+import sys
+from pathlib import Path
+
+import lz4block
+
+MAGIC = 0x495A4C4D  # "MLZI"
+HEADER_FMT = "<IIIIIIII"
+ENTRY_FMT = "<III"
+BLOCK_STORED = 0x1
+
+SEGMENTED_MAGIC = 0x47534C4D  # "MLSG"
+SEGMENTED_HEADER_FMT = "<IIII"
+SEGMENT_FMT = "<III"
+
+
+def unpack(blob: bytes):
+    (magic, version, header_size, block_size, block_count,
+     image_size, image_base, _) = struct.unpack_from(HEADER_FMT, blob, 0)
+    if magic != MAGIC:
+        raise ValueError(f"bad magic 0x{magic:08X}")
+    if version != 1:
+        raise ValueError(f"unsupported version {version}")
+
+    image = bytearray()
+    entry_size = struct.calcsize(ENTRY_FMT)
+    for b in range(block_count):
+        offset, csize, flags = struct.unpack_from(ENTRY_FMT, blob, header_size + b * entry_size)
+        raw_size = min(block_size, image_size - b * block_size)
+        payload = blob[offset : offset + csize]
+        if flags & BLOCK_STORED:
+            block = payload
+        else:
+            block = lz4block.decompress(payload, raw_size)
+        if len(block) != raw_size:
+            raise ValueError(f"block {b}: expected {raw_size} bytes, got {len(block)}")
+        image += block
+    return image_base, bytes(image)
+
+
+def segments(base: int, image: bytes):
+    """[(address, bytes)] stored by an image file: the segments of a segmented
+    image (format in inc/ImageFormat.h), or the flat image at `base`."""
+    if len(image) < 4 or struct.unpack_from("<I", image, 0)[0] != SEGMENTED_MAGIC:
+        return [(base, image)]
+    _, version, header_size, count = struct.unpack_from(SEGMENTED_HEADER_FMT, image, 0)
+    if version != 1:
+        raise ValueError(f"unsupported segmented image version {version}")
+    result = []
+    entry_size = struct.calcsize(SEGMENT_FMT)
+    for s in range(count):
+        address, size, offset = struct.unpack_from(SEGMENT_FMT, image, header_size + s * entry_size)
+        if offset + size > len(image):
+            raise ValueError(f"segment {s} at 0x{address:08X} runs past the end of the image")
+        result.append((address, image[offset : offset + size]))
+    return result
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Unpack a --compress output image")
+    parser.add_argument("input", type=Path)
+    parser.add_argument("output", type=Path)
+    args = parser.parse_args()
+
+    try:
+        base, image = unpack(args.input.read_bytes())
+    except (ValueError, struct.error) as e:
+        print(f"Error: {args.input}: {e}", file=sys.stderr)
+        return 1
+    args.output.write_bytes(image)
+    print(f"Unpacked {len(image)} bytes (base 0x{base:08X}) to {args.output}")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,111 @@
+#!/usr/bin/env python3
+"""
+Builds a library archive (.lib, format in inc/Archive.h) from .obj files, or
+lists the symbol index of an existing one. The linker reads only the index
+up front and loads a member when one of its symbols is needed.
+"""
+import argparse
+import struct
+import sys
+from pathlib import Path
+
+from obj_dump import parse_obj
+
+ARCHIVE_MAGIC = 0x4C4E4B41  # "LNKA"
+ARCHIVE_VERSION = 1
+SYMBOL_DEFINED = 1
+SYMBOL_WEAK = 2
+
+HEADER_FMT = "<IIIII"   # magic, version, member_count, symbol_count, string_table_size
+MEMBER_FMT = "<III"     # name_offset, data_offset, data_size
+SYMBOL_FMT = "<II"      # name_offset, member
+
+
+def build_archive(objects, output: Path):
+    strings = bytearray()
+    offsets = {}
+
+    def string(name: str) -> int:
+        if name not in offsets:
+            offsets[name] = len(strings)
+            strings.extend(name.encode("utf-8") + b"\0")
+        return offsets[name]
+
+    members = []  # (name_offset, blob)
+    index = []    # (name_offset, member)
+    for member, path in enumerate(objects):
+        obj = parse_obj(path)
+        members.append((string(path.name), path.read_bytes()))
+        for sym in obj["symbols"]:
+            if sym["type"] in (SYMBOL_DEFINED, SYMBOL_WEAK):
+                index.append((string(sym["name"]), member))
+
+    # Member data starts after the string table, each member word aligned
+    data_offset = (struct.calcsize(HEADER_FMT) + len(members) * struct.calcsize(MEMBER_FMT)
+                   + len(index) * struct.calcsize(SYMBOL_FMT) + len(strings))
+    table = bytearray()
+    body = bytearray()
+    for name_offset, blob in members:
+        padding = -data_offset % 4
+        body += bytes(padding)
+        data_offset += padding
+        table += struct.pack(MEMBER_FMT, name_offset, data_offset, len(blob))
+        body += blob
+        data_offset += len(blob)
+
+    with output.open("wb") as out:
+        out.write(struct.pack(HEADER_FMT, ARCHIVE_MAGIC, ARCHIVE_VERSION, len(members),
+                              len(index), len(strings)))
+        out.write(table)
+        for name_offset, member in index:
+            out.write(struct.pack(SYMBOL_FMT, name_offset, member))
+        out.write(strings)
+        out.write(body)
+    return len(members), len(index)
+
+
+def list_archive(path: Path):
+    buf = path.read_bytes()
+    magic, version, member_count, symbol_count, strings_size = struct.unpack_from(HEADER_FMT, buf)
+    if magic != ARCHIVE_MAGIC or version != ARCHIVE_VERSION:
+        raise ValueError(f"{path} is not an archive")
+    pos = struct.calcsize(HEADER_FMT)
+    members = [struct.unpack_from(MEMBER_FMT, buf, pos + i * struct.calcsize(MEMBER_FMT))
+               for i in range(member_count)]
+    pos += member_count * struct.calcsize(MEMBER_FMT)
+    symbols = [struct.unpack_from(SYMBOL_FMT, buf, pos + i * struct.calcsize(SYMBOL_FMT))
+               for i in range(symbol_count)]
+    strings = buf[pos + symbol_count * struct.calcsize(SYMBOL_FMT):][:strings_size]
+
+    def name(offset):
+        return strings[offset:strings.index(b"\0", offset)].decode("utf-8", errors="replace")
+
+    for i, (name_offset, data_offset, data_size) in enumerate(members):
+        print(f"member [{i}] {name(name_offset)} offset=0x{data_offset:x} size={data_size}")
+    for name_offset, member in symbols:
+        print(f"  {name(name_offset)} -> [{member}]")
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Build or list a MyLinker library archive")
+    parser.add_argument("archive", type=Path, help="archive to write (or read with --list)")
+    parser.add_argument("objects", type=Path, nargs="*", help="member .obj files, in order")
+    parser.add_argument("--list", action="store_true", help="print the members and symbol index")
+    args = parser.parse_args()
+
+    try:
+        if args.list:
+            list_archive(args.archive)
+            return 0
+        if not args.objects:
+            parser.error("no member objects given")
+        count, symbols = build_archive(args.objects, args.archive)
+    except (OSError, ValueError, struct.error) as e:
+        print(f"Error: {e}", file=sys.stderr)
+        return 1
+    print(f"Wrote {args.archive}: {count} members, {symbols} index symbols")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
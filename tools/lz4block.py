@@ -0,0 +1,102 @@
+"""
+LZ4 block format codec shared by the object tools.
+Matches the in-tree C++ decoder (src/Compression.cpp); no frame, no checksum.
+"""
+
+MIN_MATCH = 4
+LAST_LITERALS = 5   # The final 5 bytes are always literals
+MF_LIMIT = 12       # No match may start in the final 12 bytes
+MAX_OFFSET = 0xFFFF
+
+
+def _write_length(out: bytearray, length: int):
+    while length >= 255:
+        out.append(255)
+        length -= 255
+    out.append(length)
+
+
+def _emit(out: bytearray, literals: bytes, offset: int = 0, match_len: int = 0):
+    lit_len = len(literals)
+    ml = match_len - MIN_MATCH if match_len else 0
+    out.append((min(lit_len, 15) << 4) | min(ml, 15))
+    if lit_len >= 15:
+        _write_length(out, lit_len - 15)
+    out += literals
+    if match_len:
+        out += offset.to_bytes(2, "little")
+        if ml >= 15:
+            _write_length(out, ml - 15)
+
+
+def compress(src: bytes) -> bytes:
+    """Greedy single-probe compressor; good enough for zero-heavy objects."""
+    n = len(src)
+    if n == 0:
+        return b""
+
+    out = bytearray()
+    table = {}
+    anchor = 0
+    i = 0
+    limit = n - MF_LIMIT
+    while i < limit:
+        key = src[i : i + 4]
+        cand = table.get(key)
+        table[key] = i
+        if cand is None or i - cand > MAX_OFFSET:
+            i += 1
+            continue
+
+        match_len = MIN_MATCH
+        max_len = n - LAST_LITERALS - i
+        while match_len < max_len and src[cand + match_len] == src[i + match_len]:
+            match_len += 1
+
+        _emit(out, src[anchor:i], i - cand, match_len)
+        i += match_len
+        anchor = i
+
+    _emit(out, src[anchor:])
+    return bytes(out)
+
+
+def decompress(src: bytes, size: int) -> bytes:
+    out = bytearray()
+    ip = 0
+    while ip < len(src):
+        token = src[ip]
+        ip += 1
+        lit_len = token >> 4
+        if lit_len == 15:
+            while True:
+                b = src[ip]
+                ip += 1
+                lit_len += b
+                if b != 255:
+                    break
+        out += src[ip : ip + lit_len]
+        ip += lit_len
+        if ip >= len(src):
+            break
+
+        offset = src[ip] | (src[ip + 1] << 8)
+        ip += 2
+        match_len = token & 0x0F
+        if match_len == 15:
+            while True:
+                b = src[ip]
+                ip += 1
+                match_len += b
+                if b != 255:
+                    break
+        match_len += MIN_MATCH
+        if offset == 0 or offset > len(out):
+            raise ValueError("Bad LZ4 match offset")
+        start = len(out) - offset
+        for k in range(match_len):
+            out.append(out[start + k])
+
+    if len(out) != size:
+        raise ValueError(f"LZ4 block decoded to {len(out)} bytes, expected {size}")
+    return bytes(out)
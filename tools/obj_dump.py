@@ -8,21 +8,55 @@ import struct
 import sys
 from pathlib import Path
 
+import lz4block
+from crc32c import crc32c
+
 MAGIC = 0x4C4E4B31  # "LNK1"
+MAGIC_V2 = 0x4C4E4B32  # "LNK2"
+FLAG_RELAXABLE = 0x1
+FLAG_COMPRESSED = 0x2
+FLAG_CHECKSUMS = 0x4
+
+# Fields after the LNK1 header, in order. Missing trailing fields read as 0.
+HEADER_V2_FIELDS = [
+    "header_size",
+    "symbol_entry_size",
+    "reloc_entry_size",
+    "flags",
+    "text_align",
+    "data_align",
+    "sdata_size",
+    "sdata_align",
+    "bss_size",
+    "bss_align",
+    "text_crc",
+    "data_crc",
+    "sdata_crc",
+    "symtable_crc",
+    "reloc_crc",
+]
 
 SECTION_NAMES = {
     0: "TEXT",
     1: "DATA",
+    2: "SDATA",
+    3: "BSS",
 }
 
 SYMBOL_TYPES = {
     0: "UNDEF",
     1: "DEF",
+    2: "WEAK",
+    3: "COMM",
 }
 
 RELOC_TYPES = {
     0: "ABS",
     1: "REL",
+    2: "HI16",
+    3: "LO16",
+    4: "SDA16",
+    5: "BR26",
 }
 
 
@@ -52,37 +86,76 @@ def parse_obj(path: Path):
     magic, text_size, data_size, sym_cnt, reloc_cnt = struct.unpack_from(
         "<IIIII", buf, 0
     )
-    if magic != MAGIC:
-        raise ValueError(f"Bad magic 0x{magic:08x} (expected 0x{MAGIC:08x})")
+    ext = {name: 0 for name in HEADER_V2_FIELDS}
+    sym_size = 76
+    reloc_size = 72
+    if magic == MAGIC_V2:
+        (ext["header_size"],) = struct.unpack_from("<I", buf, hdr_size)
+        known = min(len(HEADER_V2_FIELDS), (ext["header_size"] - hdr_size) // 4)
+        values = struct.unpack_from(f"<{known}I", buf, hdr_size)
+        ext.update(zip(HEADER_V2_FIELDS, values))
+        hdr_size = ext["header_size"]
+        sym_size = ext["symbol_entry_size"]
+        reloc_size = ext["reloc_entry_size"]
+    elif magic != MAGIC:
+        raise ValueError(
+            f"Bad magic 0x{magic:08x} (expected 0x{MAGIC:08x} or 0x{MAGIC_V2:08x})"
+        )
 
     off = hdr_size
-    text = buf[off : off + text_size]
-    off += text_size
-    data_sec = buf[off : off + data_size]
-    off += data_size
+    compressed = bool(ext["flags"] & FLAG_COMPRESSED)
+    checksummed = bool(ext["flags"] & FLAG_CHECKSUMS)
+
+    def next_part(size, what, crc):
+        """Return the next stored part, verifying and decompressing it if needed."""
+        nonlocal off
+        if compressed:
+            if off + 4 > len(buf):
+                raise ValueError(f"Truncated {what}")
+            (size_stored,) = struct.unpack_from("<I", buf, off)
+            off += 4
+        else:
+            size_stored = size
+        if off + size_stored > len(buf):
+            raise ValueError(f"Truncated {what}")
+        stored = buf[off : off + size_stored]
+        off += size_stored
+        if checksummed and crc32c(stored) != crc:
+            raise ValueError(f"Checksum mismatch in {what}")
+        return lz4block.decompress(stored, size) if compressed else stored
+
+    text = next_part(text_size, "text section", ext["text_crc"])
+    data_sec = next_part(data_size, "data section", ext["data_crc"])
+    sdata_sec = next_part(ext["sdata_size"], "sdata section", ext["sdata_crc"])
+    sym_buf = next_part(sym_cnt * sym_size, "symbol table", ext["symtable_crc"])
+    reloc_buf = next_part(reloc_cnt * reloc_size, "relocation table", ext["reloc_crc"])
 
     syms = []
     sym_struct = struct.Struct("<64sIII")
-    for _ in range(sym_cnt):
-        if off + sym_struct.size > len(buf):
-            raise ValueError("Truncated symbol table")
-        raw = sym_struct.unpack_from(buf, off)
+    for i in range(sym_cnt):
+        pos = i * sym_size
+        raw = sym_struct.unpack_from(sym_buf, pos)
+        align = 0
+        size = 0
+        if sym_size >= sym_struct.size + 4:
+            (align,) = struct.unpack_from("<I", sym_buf, pos + sym_struct.size)
+        if sym_size >= sym_struct.size + 8:
+            (size,) = struct.unpack_from("<I", sym_buf, pos + sym_struct.size + 4)
         syms.append(
             {
                 "name": read_cstring(raw[0]),
                 "type": raw[1],
                 "section": raw[2],
                 "offset": raw[3],
+                "align": align,
+                "size": size,
             }
         )
-        off += sym_struct.size
 
     relocs = []
     reloc_struct = struct.Struct("<I64sI")
-    for _ in range(reloc_cnt):
-        if off + reloc_struct.size > len(buf):
-            raise ValueError("Truncated relocation table")
-        raw = reloc_struct.unpack_from(buf, off)
+    for i in range(reloc_cnt):
+        raw = reloc_struct.unpack_from(reloc_buf, i * reloc_size)
         relocs.append(
             {
                 "offset": raw[0],
@@ -90,11 +163,11 @@ def parse_obj(path: Path):
                 "type": raw[2],
             }
         )
-        off += reloc_struct.size
 
     return {
         "text": text,
         "data": data_sec,
+        "sdata": sdata_sec,
         "symbols": syms,
         "relocs": relocs,
         "header": {
@@ -102,6 +175,8 @@ def parse_obj(path: Path):
             "data_size": data_size,
             "sym_cnt": sym_cnt,
             "reloc_cnt": reloc_cnt,
+            "magic": magic,
+            **ext,
         },
     }
 
@@ -119,6 +194,20 @@ def dump_obj(path: Path, args):
         f"Header: text={hdr['text_size']} bytes, data={hdr['data_size']} bytes, "
         f"symbols={hdr['sym_cnt']}, relocs={hdr['reloc_cnt']}"
     )
+    if hdr["magic"] == MAGIC_V2:
+        notes = ""
+        if hdr["flags"] & FLAG_RELAXABLE:
+            notes += " (relaxable)"
+        if hdr["flags"] & FLAG_COMPRESSED:
+            notes += " (compressed)"
+        if hdr["flags"] & FLAG_CHECKSUMS:
+            notes += " (checksums verified)"
+        print(
+            f"        LNK2: flags=0x{hdr['flags']:x}{notes}, text_align={hdr['text_align']}, "
+            f"data_align={hdr['data_align']}, sdata={hdr['sdata_size']} bytes "
+            f"(align {hdr['sdata_align']}), bss={hdr['bss_size']} bytes "
+            f"(align {hdr['bss_align']})"
+        )
 
     if obj["text"]:
         print(f"\n.text ({len(obj['text'])} bytes)")
@@ -129,13 +218,21 @@ def dump_obj(path: Path, args):
         for line in hexdump(obj["data"], base=0, width=args.width):
             print(f"  {line}")
 
+    if obj["sdata"]:
+        print(f"\n.sdata ({len(obj['sdata'])} bytes)")
+        for line in hexdump(obj["sdata"], base=0, width=args.width):
+            print(f"  {line}")
+
     if obj["symbols"]:
         print("\nSymbols:")
         for idx, s in enumerate(obj["symbols"]):
             stype = SYMBOL_TYPES.get(s["type"], str(s["type"]))
             sect = SECTION_NAMES.get(s["section"], str(s["section"]))
+            align = f" align={s['align']}" if s["align"] > 1 else ""
+            if s["size"]:
+                align += f" size={s['size']}"
             print(
-                f"  [{idx:02d}] {s['name']:<20} type={stype:<5} section={sect:<4} offset=0x{s['offset']:x}"
+                f"  [{idx:02d}] {s['name']:<20} type={stype:<5} section={sect:<5} offset=0x{s['offset']:x}{align}"
             )
 
     if obj["relocs"]:
@@ -143,7 +240,7 @@ def dump_obj(path: Path, args):
         for idx, r in enumerate(obj["relocs"]):
             rtype = RELOC_TYPES.get(r["type"], str(r["type"]))
             print(
-                f"  [{idx:02d}] offset=0x{r['offset']:x} type={rtype:<3} symbol={r['symbol_name']}"
+                f"  [{idx:02d}] offset=0x{r['offset']:x} type={rtype:<5} symbol={r['symbol_name']}"
             )
     print()
 
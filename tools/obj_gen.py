@@ -2,22 +2,38 @@ import struct
 import json
 import sys
 
+import lz4block
+from crc32c import crc32c
+
 # Constants
-MAGIC = 0x4C4E4B31
+MAGIC = 0x4C4E4B31     # "LNK1" (fixed header and entries)
+MAGIC_V2 = 0x4C4E4B32  # "LNK2" (header records its own size and entry strides)
 SECTION_TEXT = 0
 SECTION_DATA = 1
+SECTION_SDATA = 2
+SECTION_BSS = 3
 SYMBOL_UNDEFINED = 0
 SYMBOL_DEFINED = 1
+SYMBOL_WEAK = 2
+SYMBOL_COMMON = 3
 RELOC_ABSOLUTE = 0
 RELOC_RELATIVE = 1
+RELOC_HI16 = 2
+RELOC_LO16 = 3
+RELOC_SDA16 = 4
+RELOC_BRANCH26 = 5
+OBJ_FLAG_RELAXABLE = 0x1
+OBJ_FLAG_COMPRESSED = 0x2
+OBJ_FLAG_CHECKSUMS = 0x4
 
-def create_object_file(json_path, output_path):
+def create_object_file(json_path, output_path, compress=False, checksum=False):
     with open(json_path, 'r') as f:
         data = json.load(f)
 
     # Prepare Data
     text_bytes = bytes(data.get('text', []))
     data_bytes = bytes(data.get('data', []))
+    sdata_bytes = bytes(data.get('sdata', []))
     
     symbols = data.get('symbols', [])
     relocs = data.get('relocs', [])
@@ -28,46 +44,90 @@ def create_object_file(json_path, output_path):
     # uint32_t data_size;
     # uint32_t symtable_count;
     # uint32_t reloc_count;
-    
-    header = struct.pack('<IIIII', 
-                         MAGIC, 
-                         len(text_bytes), 
-                         len(data_bytes), 
-                         len(symbols), 
-                         len(relocs))
+    # --- LNK2 ---
+    # uint32_t header_size;
+    # uint32_t symbol_entry_size;
+    # uint32_t reloc_entry_size;
+    # uint32_t flags;
+    # uint32_t text_align;
+    # uint32_t data_align;
+    # uint32_t sdata_size;
+    # uint32_t sdata_align;
+    # uint32_t bss_size;
+    # uint32_t bss_align;
+    # uint32_t text_crc, data_crc, sdata_crc, symtable_crc, reloc_crc;
+    header_fmt = '<IIIIIIIIIIIIIIIIIIII'
+    sym_fmt = '<64sIIIII'
+    reloc_fmt = '<I64sI'
+
+    # Symbols
+    # char name[64];
+    # uint32_t type;
+    # uint32_t section;
+    # uint32_t offset;
+    # uint32_t align;
+    # uint32_t size;
+    sym_table = bytearray()
+    for sym in symbols:
+        name = sym['name'].encode('utf-8')
+        # Pad name to 64 bytes
+        name = name + b'\0' * (64 - len(name))
+        sym_table += struct.pack(sym_fmt, name, sym['type'], sym['section'], sym['offset'],
+                                 sym.get('align', 0), sym.get('size', 0))
+
+    # Relocs
+    # uint32_t offset;
+    # char symbol_name[64];
+    # uint32_t type;
+    reloc_table = bytearray()
+    for reloc in relocs:
+        sym_name = reloc['symbol_name'].encode('utf-8')
+        sym_name = sym_name + b'\0' * (64 - len(sym_name))
+        reloc_table += struct.pack(reloc_fmt, reloc['offset'], sym_name, reloc['type'])
+
+    parts = [text_bytes, data_bytes, sdata_bytes, bytes(sym_table), bytes(reloc_table)]
+    if compress:
+        # Each part: uint32_t compressed length + LZ4 block
+        parts = [lz4block.compress(part) for part in parts]
+    # Checksums cover the bytes as stored, so they can be checked before decoding
+    crcs = [crc32c(part) if checksum else 0 for part in parts]
+
+    header = struct.pack(header_fmt,
+                         MAGIC_V2,
+                         len(text_bytes),
+                         len(data_bytes),
+                         len(symbols),
+                         len(relocs),
+                         struct.calcsize(header_fmt),
+                         struct.calcsize(sym_fmt),
+                         struct.calcsize(reloc_fmt),
+                         (OBJ_FLAG_RELAXABLE if data.get('relaxable') else 0) |
+                         (OBJ_FLAG_COMPRESSED if compress else 0) |
+                         (OBJ_FLAG_CHECKSUMS if checksum else 0),
+                         data.get('text_align', 0),
+                         data.get('data_align', 0),
+                         len(sdata_bytes),
+                         data.get('sdata_align', 0),
+                         data.get('bss_size', 0),
+                         data.get('bss_align', 0),
+                         *crcs)
 
     with open(output_path, 'wb') as out:
         out.write(header)
-        out.write(text_bytes)
-        out.write(data_bytes)
-        
-        # Write Symbols
-        # char name[64];
-        # uint32_t type;
-        # uint32_t section;
-        # uint32_t offset;
-        for sym in symbols:
-            name = sym['name'].encode('utf-8')
-            # Pad name to 64 bytes
-            name = name + b'\0' * (64 - len(name))
-            entry = struct.pack('<64sIII', name, sym['type'], sym['section'], sym['offset'])
-            out.write(entry)
-            
-        # Write Relocs
-        # uint32_t offset;
-        # char symbol_name[64];
-        # uint32_t type;
-        for reloc in relocs:
-            sym_name = reloc['symbol_name'].encode('utf-8')
-            sym_name = sym_name + b'\0' * (64 - len(sym_name))
-            entry = struct.pack('<I64sI', reloc['offset'], sym_name, reloc['type'])
-            out.write(entry)
-            
+        for part in parts:
+            if compress:
+                out.write(struct.pack('<I', len(part)))
+            out.write(part)
+
     print(f"Created {output_path}")
 
 if __name__ == "__main__":
-    if len(sys.argv) < 3:
-        print("Usage: python obj_gen.py <input.json> <output.obj>")
+    args = sys.argv[1:]
+    compress = '--compress' in args
+    checksum = '--checksum' in args
+    args = [a for a in args if a not in ('--compress', '--checksum')]
+    if len(args) < 2:
+        print("Usage: python obj_gen.py [--compress] [--checksum] <input.json> <output.obj>")
         sys.exit(1)
-        
-    create_object_file(sys.argv[1], sys.argv[2])
+
+    create_object_file(args[0], args[1], compress, checksum)
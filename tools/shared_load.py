@@ -0,0 +1,126 @@
+#!/usr/bin/env python3
+"""
+Test loader for prelinked shared images. Maps a program image and the shared
+images it was linked against (`mllinker --link-shared`) into one address
+space, as MyEmulator would, and writes the result as a flat memory dump
+starting at the lowest mapped address.
+"""
+import argparse
+import struct
+import sys
+from pathlib import Path
+
+from img_unpack import MAGIC as COMPRESSED_MAGIC, segments, unpack
+
+
+def read_image(path: Path, base: int):
+    """Return (base, file bytes, [(address, bytes)]) of a flat, segmented or
+    --compress image."""
+    blob = path.read_bytes()
+    if len(blob) >= 4 and struct.unpack_from("<I", blob, 0)[0] == COMPRESSED_MAGIC:
+        base, blob = unpack(blob)
+    return base, blob, segments(base, blob)
+
+
+def read_symbols(path: Path):
+    """Parse a --shared symbol file (format in inc/SharedImage.h)."""
+    info = {"ranges": [], "bss": None, "symbols": {}}
+    for line_no, line in enumerate(path.read_text().splitlines(), 1):
+        line = line.split("#", 1)[0].strip()
+        if not line:
+            continue
+        keyword, rest = (line.split(None, 1) + [""])[:2]
+        if keyword == "image":
+            base, size, image = rest.split(None, 2)
+            info["base"], info["size"], info["image"] = int(base, 0), int(size, 0), image
+        elif keyword in ("range", "bss"):
+            start, end = (int(v, 0) for v in rest.split())
+            if keyword == "range":
+                info["ranges"].append((start, end))
+            else:
+                info["bss"] = (start, end)
+        elif keyword == "symbol":
+            name, addr = rest.split()
+            info["symbols"][name] = int(addr, 0)
+        else:
+            raise ValueError(f"{path}:{line_no}: unknown keyword '{keyword}'")
+    if "image" not in info:
+        raise ValueError(f"{path}: no 'image' record")
+    return info
+
+
+def locate(image: str, symbols_path: Path) -> Path:
+    """The image path as recorded, else relative to the symbol file."""
+    path = Path(image)
+    if path.exists() or path.is_absolute():
+        return path
+    return symbols_path.parent / path.name
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Map a program and its shared images")
+    parser.add_argument("program", type=Path, help="program image (flat, segmented or --compress)")
+    parser.add_argument("--base", type=lambda v: int(v, 0), default=0,
+                        help="load address of a flat program image (default: 0)")
+    parser.add_argument("--shared", type=Path, action="append", default=[],
+                        help="symbol file written by mllinker --shared (repeatable)")
+    parser.add_argument("-o", "--output", type=Path, help="write the memory dump here")
+    parser.add_argument("--symbol", action="append", default=[],
+                        help="print the address and first word of a shared symbol")
+    args = parser.parse_args()
+
+    try:
+        _, _, program = read_image(args.program, args.base)
+        mapped = [("program", address, data) for address, data in program]
+        exports = {}
+        for sym_path in args.shared:
+            info = read_symbols(sym_path)
+            base, blob, image = read_image(locate(info["image"], sym_path), info["base"])
+            if base != info["base"] or len(blob) != info["size"]:
+                raise ValueError(f"{info['image']} does not match {sym_path} (relinked?)")
+            mapped += [(info["image"], address, data) for address, data in image]
+            if info["bss"]:
+                start, end = info["bss"]
+                mapped.append((f"{info['image']} bss", start, bytes(end - start)))
+            exports.update(info["symbols"])
+    except (OSError, ValueError, struct.error) as e:
+        print(f"Error: {e}", file=sys.stderr)
+        return 1
+
+    mapped.sort(key=lambda s: s[1])
+    for (name_a, base_a, data_a), (name_b, base_b, _) in zip(mapped, mapped[1:]):
+        if base_a + len(data_a) > base_b:
+            print(f"Error: {name_a} overlaps {name_b}", file=sys.stderr)
+            return 1
+
+    for name, base, data in mapped:
+        print(f"Mapped {name}: 0x{base:08X}-0x{base + len(data):08X} ({len(data)} bytes)")
+
+    def peek(addr, size=4):
+        for _, base, data in mapped:
+            if base <= addr < base + len(data):
+                return data[addr - base : addr - base + size]
+        return b""
+
+    for name in args.symbol:
+        if name not in exports:
+            print(f"Error: symbol '{name}' is not exported by any shared image", file=sys.stderr)
+            return 1
+        addr = exports[name]
+        print(f"{name} = 0x{addr:08X} [{peek(addr).hex()}]")
+
+    if args.output:
+        # Seek over the gaps so the (often gigabyte-sized) hole stays sparse
+        low = mapped[0][1]
+        high = max(base + len(data) for _, base, data in mapped)
+        with args.output.open("wb") as out:
+            for _, base, data in mapped:
+                out.seek(base - low)
+                out.write(data)
+            out.truncate(high - low)
+        print(f"Wrote {high - low} bytes (base 0x{low:08X}) to {args.output}")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())